@@ -20,10 +20,12 @@
 
 #include "mobile-settings-config.h"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <locale.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <glib/gi18n-lib.h>
 #include <gtk/gtk.h>
 
@@ -33,6 +35,7 @@
 #include <libgnome-desktop/gnome-languages.h>
 
 #include "ms-common-language.h"
+#include "ms-locale-names.h"
 
 static char *get_lang_for_user_object_path (const char *path);
 
@@ -53,15 +56,15 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
                         return TRUE;
         } while (gtk_tree_model_iter_next (model, iter));
 
-        name = gnome_normalize_locale (lang);
+        name = ms_locale_names_normalize_locale (lang);
         if (name != NULL) {
                 g_autofree gchar *language = NULL;
 
                 if (region) {
-                        language = gnome_get_country_from_locale (name, NULL);
+                        language = ms_locale_names_get_country_from_locale (name, NULL);
                 }
                 else {
-                        language = gnome_get_language_from_locale (name, NULL);
+                        language = ms_locale_names_get_language_from_locale (name, NULL);
                 }
 
                 gtk_list_store_insert_with_values (GTK_LIST_STORE (model),
@@ -85,60 +88,200 @@ ms_common_language_get_iter_for_language (GtkTreeModel *model,
   return iter_for_language (model, lang, iter, FALSE);
 }
 
-gboolean
-ms_common_language_has_font (const gchar *locale)
+#define FONT_LANGS_CACHE_DIR   "phosh-mobile-settings"
+#define FONT_LANGS_CACHE_FILE  "font-languages.ini"
+#define FONT_LANGS_CACHE_GROUP "Fonts"
+
+static FcLangSet *font_langs;
+G_LOCK_DEFINE_STATIC (font_langs);
+
+static void
+stamp_add_mtimes (FcStrList *list,
+                  gint64    *newest,
+                  guint     *count)
 {
-        const FcCharSet  *charset;
-        FcPattern        *pattern;
-        FcObjectSet      *object_set;
-        FcFontSet        *font_set;
-        g_autofree gchar *language_code = NULL;
-        gboolean          is_displayable;
+        FcChar8 *path;
 
-        is_displayable = FALSE;
-        pattern = NULL;
-        object_set = NULL;
-        font_set = NULL;
+        if (list == NULL)
+                return;
 
-        if (!gnome_parse_locale (locale, &language_code, NULL, NULL, NULL))
-                return FALSE;
+        while ((path = FcStrListNext (list)) != NULL) {
+                GStatBuf st;
+
+                (*count)++;
+                if (g_stat ((const char *) path, &st) != 0)
+                        continue;
+
+                *newest = MAX (*newest, (gint64) st.st_mtime);
+        }
+
+        FcStrListDone (list);
+}
+
+/*
+ * Fontconfig rescans a font directory when its mtime changes so the
+ * newest mtime of all font dirs and config files (plus their number
+ * to catch removals) tells us whether the set of fonts changed.
+ */
+static char *
+get_font_config_stamp (void)
+{
+        gint64 newest = 0;
+        guint count = 0;
+
+        stamp_add_mtimes (FcConfigGetConfigFiles (NULL), &newest, &count);
+        stamp_add_mtimes (FcConfigGetFontDirs (NULL), &newest, &count);
+
+        return g_strdup_printf ("%d-%" G_GINT64_FORMAT "-%u", FcGetVersion (), newest, count);
+}
+
+static char *
+get_font_langs_cache_path (void)
+{
+        return g_build_filename (g_get_user_cache_dir (),
+                                 FONT_LANGS_CACHE_DIR,
+                                 FONT_LANGS_CACHE_FILE,
+                                 NULL);
+}
+
+static FcLangSet *
+load_font_langs_cache (const char *stamp)
+{
+        g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+        g_autofree char *path = get_font_langs_cache_path ();
+        g_autofree char *cached_stamp = NULL;
+        g_auto (GStrv) langs = NULL;
+        FcLangSet *langset;
+
+        if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, NULL))
+                return NULL;
+
+        cached_stamp = g_key_file_get_string (keyfile, FONT_LANGS_CACHE_GROUP, "Stamp", NULL);
+        if (g_strcmp0 (cached_stamp, stamp) != 0)
+                return NULL;
+
+        langs = g_key_file_get_string_list (keyfile, FONT_LANGS_CACHE_GROUP, "Languages", NULL, NULL);
+        if (langs == NULL)
+                return NULL;
 
-        charset = FcLangGetCharSet ((FcChar8 *) language_code);
-        if (!charset) {
-                /* fontconfig does not know about this language */
-                is_displayable = TRUE;
+        langset = FcLangSetCreate ();
+        for (int i = 0; langs[i] != NULL; i++)
+                FcLangSetAdd (langset, (const FcChar8 *) langs[i]);
+
+        return langset;
+}
+
+static void
+save_font_langs_cache (const char *stamp,
+                       FcLangSet  *langset)
+{
+        g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+        g_autoptr (GPtrArray) langs = g_ptr_array_new_with_free_func (g_free);
+        g_autofree char *path = get_font_langs_cache_path ();
+        g_autofree char *dir = g_path_get_dirname (path);
+        g_autoptr (GError) err = NULL;
+        FcStrSet *set;
+        FcStrList *list;
+        FcChar8 *lang;
+
+        set = FcLangSetGetLangs (langset);
+        list = FcStrListCreate (set);
+        while ((lang = FcStrListNext (list)) != NULL)
+                g_ptr_array_add (langs, g_strdup ((const char *) lang));
+        FcStrListDone (list);
+        FcStrSetDestroy (set);
+
+        g_key_file_set_string (keyfile, FONT_LANGS_CACHE_GROUP, "Stamp", stamp);
+        g_key_file_set_string_list (keyfile,
+                                    FONT_LANGS_CACHE_GROUP,
+                                    "Languages",
+                                    (const char * const *) langs->pdata,
+                                    langs->len);
+
+        if (g_mkdir_with_parents (dir, 0700) != 0) {
+                g_debug ("Failed to create %s: %s", dir, g_strerror (errno));
+                return;
         }
-        else {
-                /* see if any fonts support rendering it */
-                pattern = FcPatternBuild (NULL, FC_LANG, FcTypeString, language_code, NULL);
 
-                if (pattern == NULL)
-                        goto done;
+        if (!g_key_file_save_to_file (keyfile, path, &err))
+                g_debug ("Failed to save font language cache: %s", err->message);
+}
 
-                object_set = FcObjectSetCreate ();
+/*
+ * Collect the languages supported by any installed font in a single
+ * FcFontList () call rather than listing fonts once per locale.
+ */
+static FcLangSet *
+scan_font_langs (void)
+{
+        FcPattern *pattern;
+        FcObjectSet *object_set;
+        FcFontSet *font_set;
+        FcLangSet *langset;
+
+        langset = FcLangSetCreate ();
 
-                if (object_set == NULL)
-                        goto done;
+        pattern = FcPatternCreate ();
+        object_set = FcObjectSetBuild (FC_LANG, NULL);
+        font_set = FcFontList (NULL, pattern, object_set);
 
-                font_set = FcFontList (NULL, pattern, object_set);
+        for (int i = 0; font_set && i < font_set->nfont; i++) {
+                FcLangSet *font_langset;
+                FcLangSet *merged;
 
-                if (font_set == NULL)
-                        goto done;
+                if (FcPatternGetLangSet (font_set->fonts[i], FC_LANG, 0, &font_langset) != FcResultMatch)
+                        continue;
 
-                is_displayable = (font_set->nfont > 0);
+                merged = FcLangSetUnion (langset, font_langset);
+                FcLangSetDestroy (langset);
+                langset = merged;
         }
 
- done:
         if (font_set != NULL)
                 FcFontSetDestroy (font_set);
+        FcObjectSetDestroy (object_set);
+        FcPatternDestroy (pattern);
+
+        return langset;
+}
+
+static FcLangSet *
+get_font_langs (void)
+{
+        g_autofree char *stamp = NULL;
+
+        G_LOCK (font_langs);
 
-        if (object_set != NULL)
-                FcObjectSetDestroy (object_set);
+        if (font_langs != NULL)
+                goto out;
 
-        if (pattern != NULL)
-                FcPatternDestroy (pattern);
+        stamp = get_font_config_stamp ();
+        font_langs = load_font_langs_cache (stamp);
+        if (font_langs != NULL)
+                goto out;
 
-        return is_displayable;
+        font_langs = scan_font_langs ();
+        save_font_langs_cache (stamp, font_langs);
+
+ out:
+        G_UNLOCK (font_langs);
+        return font_langs;
+}
+
+gboolean
+ms_common_language_has_font (const gchar *locale)
+{
+        g_autofree gchar *language_code = NULL;
+
+        if (!ms_locale_names_parse_locale (locale, &language_code, NULL, NULL, NULL))
+                return FALSE;
+
+        /* fontconfig does not know about this language */
+        if (!FcLangGetCharSet ((FcChar8 *) language_code))
+                return TRUE;
+
+        /* see if any fonts support rendering it */
+        return FcLangSetHasLang (get_font_langs (), (FcChar8 *) language_code) != FcLangDifferentLang;
 }
 
 gchar *
@@ -155,7 +298,7 @@ ms_common_language_get_current_language (void)
 
         locale = (const gchar *) setlocale (LC_MESSAGES, NULL);
         if (locale)
-                language = gnome_normalize_locale (locale);
+                language = ms_locale_names_normalize_locale (locale);
         else
                 language = NULL;
 
@@ -202,24 +345,9 @@ static void
 insert_language (GHashTable *ht,
                  const char *lang)
 {
-        g_autofree gchar *label_own_lang = NULL;
-        g_autofree gchar *label_current_lang = NULL;
-        g_autofree gchar *label_untranslated = NULL;
-
-        label_own_lang = gnome_get_language_from_locale (lang, lang);
-        label_current_lang = gnome_get_language_from_locale (lang, NULL);
-        label_untranslated = gnome_get_language_from_locale (lang, "C");
-
-        /* We don't have a translation for the label in
-         * its own language? */
-        if (g_strcmp0 (label_own_lang, label_untranslated) == 0) {
-                if (g_strcmp0 (label_current_lang, label_untranslated) == 0)
-                        g_hash_table_insert (ht, g_strdup (lang), g_strdup (label_untranslated));
-                else
-                        g_hash_table_insert (ht, g_strdup (lang), g_strdup (label_current_lang));
-        } else {
-                g_hash_table_insert (ht, g_strdup (lang), g_strdup (label_own_lang));
-        }
+        const MsLocaleNames *names = ms_locale_names_lookup (lang);
+
+        g_hash_table_insert (ht, g_strdup (lang), g_strdup (names->label));
 }
 
 GHashTable *
@@ -284,7 +412,7 @@ G_GNUC_END_IGNORE_DEPRECATIONS
                 g_autofree gchar *country = NULL;
                 g_autofree gchar *codeset = NULL;
 
-                gnome_parse_locale (name, &language, &country, &codeset, NULL);
+                ms_locale_names_parse_locale (name, &language, &country, &codeset, NULL);
 
                 if (!codeset || !g_str_equal (codeset, "UTF-8"))
                         g_warning ("Current user locale codeset isn't UTF-8");
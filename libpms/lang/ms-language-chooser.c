@@ -31,11 +31,9 @@
 #include <gtk/gtk.h>
 
 #include "ms-common-language.h"
+#include "ms-locale-names.h"
 #include "ms-util.h"
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
-
 struct _MsLanguageChooser {
         AdwDialog parent_instance;
 
@@ -65,7 +63,7 @@ add_all_languages (MsLanguageChooser *self)
         g_auto(GStrv) locale_ids = NULL;
         g_autoptr(GHashTable) initial = NULL;
 
-        locale_ids = gnome_get_all_locales ();
+        locale_ids = ms_locale_names_get_all_locales ();
         initial = ms_common_language_get_initial_languages ();
         for (int i = 0; locale_ids[i] != NULL; i++) {
                 MsLanguageRow *row;
@@ -17,11 +17,9 @@
  */
 
 #include "ms-language-row.h"
+#include "ms-locale-names.h"
 #include "ms-util.h"
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
-
 struct _MsLanguageRow {
   GtkListBoxRow parent_instance;
 
@@ -40,24 +38,6 @@ struct _MsLanguageRow {
 
 G_DEFINE_TYPE (MsLanguageRow, ms_language_row, GTK_TYPE_LIST_BOX_ROW)
 
-static gchar *
-get_language_label (const gchar *language_code,
-                    const gchar *modifier,
-                    const gchar *locale_id)
-{
-  g_autofree gchar *language = NULL;
-
-  language = gnome_get_language_from_code (language_code, locale_id);
-
-  if (modifier == NULL)
-    return g_steal_pointer (&language);
-  else
-    {
-      g_autofree gchar *t_mod = gnome_get_translated_modifier (modifier, locale_id);
-      return g_strdup_printf ("%s — %s", language, t_mod);
-    }
-}
-
 static void
 ms_language_row_dispose (GObject *object)
 {
@@ -99,30 +79,21 @@ MsLanguageRow *
 ms_language_row_new (const gchar *locale_id)
 {
   MsLanguageRow *self;
-  g_autofree gchar *language_code = NULL;
-  g_autofree gchar *country_code = NULL;
-  g_autofree gchar *modifier = NULL;
+  const MsLocaleNames *names;
 
   self = g_object_new (MS_TYPE_LANGUAGE_ROW, NULL);
   self->locale_id = g_strdup (locale_id);
 
-  gnome_parse_locale (locale_id, &language_code, &country_code, NULL, &modifier);
+  names = ms_locale_names_lookup (locale_id);
 
-  self->language = get_language_label (language_code, modifier, locale_id);
-  self->language_local = get_language_label (language_code, modifier, NULL);
+  self->language = g_strdup (names->language);
+  self->language_local = g_strdup (names->language_local);
   gtk_label_set_label (self->language_label, self->language);
 
-  if (country_code == NULL)
-    {
-      self->country = NULL;
-      self->country_local = NULL;
-    }
-  else
-    {
-      self->country = gnome_get_country_from_code (country_code, locale_id);
-      self->country_local = gnome_get_country_from_code (country_code, NULL);
-      gtk_label_set_label (self->country_label, self->country);
-    }
+  self->country = g_strdup (names->country);
+  self->country_local = g_strdup (names->country_local);
+  if (self->country)
+    gtk_label_set_label (self->country_label, self->country);
 
   return self;
 }
@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-locale-names"
+
+#include "mobile-settings-config.h"
+
+#include "ms-locale-names.h"
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#define GNOME_DESKTOP_USE_UNSTABLE_API
+#include <libgnome-desktop/gnome-languages.h>
+
+#include <errno.h>
+#include <locale.h>
+
+#define CACHE_DIR   "phosh-mobile-settings"
+#define CACHE_GROUP "Cache"
+
+#define ISO_CODES_PREFIX MOBILE_SETTINGS_ISO_CODES_PREFIX
+
+/*
+ * Looking up display names via gnome-desktop walks the iso-codes XML
+ * and switches locales for each translation. This keeps a table of
+ * all display names keyed by locale ID for the current UI language.
+ * It's built on a worker thread on first use and persisted in
+ * `$XDG_CACHE_HOME` so later runs only need to load a key file.
+ *
+ * gnome-desktop's language functions aren't thread safe so all calls
+ * into them are serialized via `gnome_lock`. Code outside of this file
+ * must use the `ms_locale_names_*` wrappers below instead of calling
+ * gnome-desktop's locale functions directly.
+ */
+
+typedef enum {
+  TABLE_STATE_NONE,
+  TABLE_STATE_BUILDING,
+  TABLE_STATE_READY,
+} TableState;
+
+/* Depending on its version gnome-desktop uses one of these */
+static const char * const iso_codes_domains[] = {
+  "iso_639", "iso_639-2", "iso_639-3", "iso_3166", "iso_3166-1", NULL
+};
+
+static GMutex      gnome_lock;
+static GMutex      table_lock;
+static GCond       table_cond;
+static TableState  table_state;
+static GHashTable *table;
+
+
+static void
+ms_locale_names_free (MsLocaleNames *names)
+{
+  g_free (names->language);
+  g_free (names->language_local);
+  g_free (names->country);
+  g_free (names->country_local);
+  g_free (names->label);
+  g_free (names);
+}
+
+
+static GHashTable *
+names_table_new (void)
+{
+  return g_hash_table_new_full (g_str_hash,
+                                g_str_equal,
+                                g_free,
+                                (GDestroyNotify) ms_locale_names_free);
+}
+
+
+static char *
+get_language_label (const char *language_code, const char *modifier, const char *locale_id)
+{
+  g_autofree char *language = NULL;
+
+  language = gnome_get_language_from_code (language_code, locale_id);
+
+  if (modifier == NULL)
+    return g_steal_pointer (&language);
+  else {
+    g_autofree char *t_mod = gnome_get_translated_modifier (modifier, locale_id);
+    return g_strdup_printf ("%s — %s", language, t_mod);
+  }
+}
+
+/*
+ * Prefer the name in the locale's own language, then the one in the
+ * current language and fall back to the untranslated one.
+ */
+static char *
+get_label (const char *locale_id)
+{
+  g_autofree char *label_own_lang = NULL;
+  g_autofree char *label_current_lang = NULL;
+  g_autofree char *label_untranslated = NULL;
+
+  label_own_lang = gnome_get_language_from_locale (locale_id, locale_id);
+  label_current_lang = gnome_get_language_from_locale (locale_id, NULL);
+  label_untranslated = gnome_get_language_from_locale (locale_id, "C");
+
+  if (g_strcmp0 (label_own_lang, label_untranslated) != 0)
+    return g_steal_pointer (&label_own_lang);
+
+  if (g_strcmp0 (label_current_lang, label_untranslated) != 0)
+    return g_steal_pointer (&label_current_lang);
+
+  return g_steal_pointer (&label_untranslated);
+}
+
+
+static MsLocaleNames *
+compute_names (const char *locale_id)
+{
+  MsLocaleNames *names = g_new0 (MsLocaleNames, 1);
+  g_autofree char *language_code = NULL;
+  g_autofree char *country_code = NULL;
+  g_autofree char *modifier = NULL;
+
+  g_mutex_lock (&gnome_lock);
+
+  if (!gnome_parse_locale (locale_id, &language_code, &country_code, NULL, &modifier))
+    goto out;
+
+  names->language = get_language_label (language_code, modifier, locale_id);
+  names->language_local = get_language_label (language_code, modifier, NULL);
+
+  if (country_code) {
+    names->country = gnome_get_country_from_code (country_code, locale_id);
+    names->country_local = gnome_get_country_from_code (country_code, NULL);
+  }
+
+  names->label = get_label (locale_id);
+
+ out:
+  g_mutex_unlock (&gnome_lock);
+  return names;
+}
+
+
+static void
+stamp_add_mtime (const char *path, gint64 *newest, guint *count)
+{
+  GStatBuf st;
+
+  if (g_stat (path, &st) != 0)
+    return;
+
+  (*count)++;
+  *newest = MAX (*newest, (gint64) st.st_mtime);
+}
+
+/*
+ * The names depend on the installed iso-codes data and its
+ * translations into every language so the newest mtime of all of
+ * these (plus their number to catch removals) tells us whether the
+ * names might have changed.
+ */
+static char *
+get_cache_stamp (void)
+{
+  g_autoptr (GDir) dir = NULL;
+  const char *lang;
+  gint64 newest = 0;
+  guint count = 0;
+
+  for (guint i = 0; iso_codes_domains[i]; i++) {
+    g_autofree char *xml = g_strdup_printf ("%s.xml", iso_codes_domains[i]);
+    g_autofree char *json = g_strdup_printf ("%s.json", iso_codes_domains[i]);
+    g_autofree char *xml_path = NULL;
+    g_autofree char *json_path = NULL;
+
+    xml_path = g_build_filename (ISO_CODES_PREFIX, "share", "xml", "iso-codes", xml, NULL);
+    stamp_add_mtime (xml_path, &newest, &count);
+    json_path = g_build_filename (ISO_CODES_PREFIX, "share", "iso-codes", "json", json, NULL);
+    stamp_add_mtime (json_path, &newest, &count);
+  }
+
+  dir = g_dir_open (ISO_CODES_PREFIX "/share/locale", 0, NULL);
+  while (dir && (lang = g_dir_read_name (dir))) {
+    for (guint i = 0; iso_codes_domains[i]; i++) {
+      g_autofree char *mo = g_strdup_printf ("%s.mo", iso_codes_domains[i]);
+      g_autofree char *mo_path = NULL;
+
+      mo_path = g_build_filename (ISO_CODES_PREFIX, "share", "locale", lang, "LC_MESSAGES", mo, NULL);
+      stamp_add_mtime (mo_path, &newest, &count);
+    }
+  }
+
+  return g_strdup_printf ("%s-%" G_GINT64_FORMAT "-%u", PACKAGE_VERSION, newest, count);
+}
+
+
+static char *
+get_cache_path (const char *ui_lang)
+{
+  g_autofree char *filename = g_strdup_printf ("locale-names-%s.ini", ui_lang);
+
+  g_strdelimit (filename, G_DIR_SEPARATOR_S, '_');
+  return g_build_filename (g_get_user_cache_dir (), CACHE_DIR, filename, NULL);
+}
+
+
+static GHashTable *
+load_cache (const char *path, const char *cache_stamp)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr (GHashTable) names_table = NULL;
+  g_autofree char *stamp = NULL;
+  g_auto (GStrv) groups = NULL;
+
+  if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, NULL))
+    return NULL;
+
+  stamp = g_key_file_get_string (keyfile, CACHE_GROUP, "Stamp", NULL);
+  if (g_strcmp0 (stamp, cache_stamp) != 0) {
+    g_debug ("Locale name cache %s is stale", path);
+    return NULL;
+  }
+
+  names_table = names_table_new ();
+  groups = g_key_file_get_groups (keyfile, NULL);
+  for (int i = 0; groups[i]; i++) {
+    MsLocaleNames *names;
+
+    if (g_str_equal (groups[i], CACHE_GROUP))
+      continue;
+
+    names = g_new0 (MsLocaleNames, 1);
+    names->language = g_key_file_get_string (keyfile, groups[i], "Language", NULL);
+    names->language_local = g_key_file_get_string (keyfile, groups[i], "LanguageLocal", NULL);
+    names->country = g_key_file_get_string (keyfile, groups[i], "Country", NULL);
+    names->country_local = g_key_file_get_string (keyfile, groups[i], "CountryLocal", NULL);
+    names->label = g_key_file_get_string (keyfile, groups[i], "Label", NULL);
+    g_hash_table_insert (names_table, g_strdup (groups[i]), names);
+  }
+
+  return g_steal_pointer (&names_table);
+}
+
+
+static void
+set_optional_string (GKeyFile *keyfile, const char *group, const char *key, const char *value)
+{
+  if (value)
+    g_key_file_set_string (keyfile, group, key, value);
+}
+
+
+static void
+save_cache (const char *path, const char *cache_stamp, GHashTable *names_table)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autoptr (GError) err = NULL;
+  GHashTableIter iter;
+  const char *locale_id;
+  MsLocaleNames *names;
+
+  g_key_file_set_string (keyfile, CACHE_GROUP, "Stamp", cache_stamp);
+
+  g_hash_table_iter_init (&iter, names_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &locale_id, (gpointer *) &names)) {
+    set_optional_string (keyfile, locale_id, "Language", names->language);
+    set_optional_string (keyfile, locale_id, "LanguageLocal", names->language_local);
+    set_optional_string (keyfile, locale_id, "Country", names->country);
+    set_optional_string (keyfile, locale_id, "CountryLocal", names->country_local);
+    set_optional_string (keyfile, locale_id, "Label", names->label);
+  }
+
+  if (g_mkdir_with_parents (dir, 0700) != 0) {
+    g_debug ("Failed to create %s: %s", dir, g_strerror (errno));
+    return;
+  }
+
+  if (!g_key_file_save_to_file (keyfile, path, &err))
+    g_debug ("Failed to save locale name cache: %s", err->message);
+}
+
+
+static void
+build_table_in_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  const char *ui_lang = task_data;
+  g_autofree char *path = get_cache_path (ui_lang);
+  g_autofree char *cache_stamp = get_cache_stamp ();
+  g_autoptr (GHashTable) names_table = NULL;
+
+  names_table = load_cache (path, cache_stamp);
+  if (names_table == NULL) {
+    g_auto (GStrv) locale_ids = NULL;
+
+    g_mutex_lock (&gnome_lock);
+    locale_ids = gnome_get_all_locales ();
+    g_mutex_unlock (&gnome_lock);
+
+    names_table = names_table_new ();
+    for (int i = 0; locale_ids[i]; i++)
+      g_hash_table_insert (names_table, g_strdup (locale_ids[i]), compute_names (locale_ids[i]));
+
+    save_cache (path, cache_stamp, names_table);
+  }
+
+  g_mutex_lock (&table_lock);
+  table = g_steal_pointer (&names_table);
+  table_state = TABLE_STATE_READY;
+  g_cond_broadcast (&table_cond);
+  g_mutex_unlock (&table_lock);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * ms_locale_names_ensure:
+ *
+ * Start building the locale name table in the background unless
+ * that already happened. Calling this early makes sure later lookups
+ * don't have to wait. See ms_lang_prefetch_locale_names().
+ */
+void
+ms_locale_names_ensure (void)
+{
+  g_autoptr (GTask) task = NULL;
+
+  g_mutex_lock (&table_lock);
+  if (table_state != TABLE_STATE_NONE) {
+    g_mutex_unlock (&table_lock);
+    return;
+  }
+  table_state = TABLE_STATE_BUILDING;
+  g_mutex_unlock (&table_lock);
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_source_tag (task, ms_locale_names_ensure);
+  g_task_set_task_data (task, g_strdup (setlocale (LC_MESSAGES, NULL)), g_free);
+  g_task_run_in_thread (task, build_table_in_thread);
+}
+
+static void
+wait_for_table_locked (void)
+{
+  while (table_state != TABLE_STATE_READY)
+    g_cond_wait (&table_cond, &table_lock);
+}
+
+/**
+ * ms_locale_names_get_all_locales:
+ *
+ * Like gnome_get_all_locales() but waits for the table to be built
+ * so the returned locales can be looked up without blocking.
+ *
+ * Returns:(transfer full): The available locales
+ */
+char **
+ms_locale_names_get_all_locales (void)
+{
+  char **locale_ids;
+
+  ms_locale_names_ensure ();
+
+  g_mutex_lock (&table_lock);
+  wait_for_table_locked ();
+  g_mutex_unlock (&table_lock);
+
+  g_mutex_lock (&gnome_lock);
+  locale_ids = gnome_get_all_locales ();
+  g_mutex_unlock (&gnome_lock);
+
+  return locale_ids;
+}
+
+/**
+ * ms_locale_names_lookup:
+ * @locale_id: The locale to look up
+ *
+ * Look up the display names of @locale_id. If the table is still
+ * being built this waits for it to finish. Locales not in the table
+ * are computed on demand.
+ *
+ * Returns:(transfer none): The locale's display names
+ */
+const MsLocaleNames *
+ms_locale_names_lookup (const char *locale_id)
+{
+  MsLocaleNames *names;
+
+  g_return_val_if_fail (locale_id, NULL);
+
+  ms_locale_names_ensure ();
+
+  g_mutex_lock (&table_lock);
+  wait_for_table_locked ();
+
+  names = g_hash_table_lookup (table, locale_id);
+  if (names == NULL) {
+    names = compute_names (locale_id);
+    g_hash_table_insert (table, g_strdup (locale_id), names);
+  }
+  g_mutex_unlock (&table_lock);
+
+  return names;
+}
+
+/**
+ * ms_locale_names_get_language_from_locale:
+ * @locale: a locale string
+ * @translation: (nullable): a locale string
+ *
+ * Like gnome_get_language_from_locale() but safe to use while the
+ * table is being built.
+ *
+ * Returns:(transfer full): the language description
+ */
+char *
+ms_locale_names_get_language_from_locale (const char *locale, const char *translation)
+{
+  char *name;
+
+  g_mutex_lock (&gnome_lock);
+  name = gnome_get_language_from_locale (locale, translation);
+  g_mutex_unlock (&gnome_lock);
+
+  return name;
+}
+
+/**
+ * ms_locale_names_get_country_from_locale:
+ * @locale: a locale string
+ * @translation: (nullable): a locale string
+ *
+ * Like gnome_get_country_from_locale() but safe to use while the
+ * table is being built.
+ *
+ * Returns:(transfer full): the country description
+ */
+char *
+ms_locale_names_get_country_from_locale (const char *locale, const char *translation)
+{
+  char *name;
+
+  g_mutex_lock (&gnome_lock);
+  name = gnome_get_country_from_locale (locale, translation);
+  g_mutex_unlock (&gnome_lock);
+
+  return name;
+}
+
+/**
+ * ms_locale_names_normalize_locale:
+ * @locale: a locale string
+ *
+ * Like gnome_normalize_locale() but safe to use while the table is
+ * being built.
+ *
+ * Returns:(transfer full)(nullable): the normalized locale
+ */
+char *
+ms_locale_names_normalize_locale (const char *locale)
+{
+  char *normalized;
+
+  g_mutex_lock (&gnome_lock);
+  normalized = gnome_normalize_locale (locale);
+  g_mutex_unlock (&gnome_lock);
+
+  return normalized;
+}
+
+/**
+ * ms_locale_names_parse_locale:
+ * @locale: a locale string
+ * @language_codep:(out)(optional): the language code
+ * @country_codep:(out)(optional): the country code
+ * @codesetp:(out)(optional): the codeset
+ * @modifierp:(out)(optional): the modifier
+ *
+ * Like gnome_parse_locale() but safe to use while the table is being
+ * built.
+ *
+ * Returns: %TRUE if parsing was successful
+ */
+gboolean
+ms_locale_names_parse_locale (const char  *locale,
+                              char       **language_codep,
+                              char       **country_codep,
+                              char       **codesetp,
+                              char       **modifierp)
+{
+  gboolean ret;
+
+  g_mutex_lock (&gnome_lock);
+  ret = gnome_parse_locale (locale, language_codep, country_codep, codesetp, modifierp);
+  g_mutex_unlock (&gnome_lock);
+
+  return ret;
+}
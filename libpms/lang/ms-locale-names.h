@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * MsLocaleNames:
+ * @language: The language name in the locale's own language
+ * @language_local: The language name in the current UI language
+ * @country: The country name in the locale's own language
+ * @country_local: The country name in the current UI language
+ * @label: The label used when listing the locale as a user language
+ *
+ * Precomputed display names of a locale.
+ */
+typedef struct {
+  char *language;
+  char *language_local;
+  char *country;
+  char *country_local;
+  char *label;
+} MsLocaleNames;
+
+void                 ms_locale_names_ensure                   (void);
+char               **ms_locale_names_get_all_locales          (void);
+const MsLocaleNames *ms_locale_names_lookup                   (const char *locale_id);
+char                *ms_locale_names_get_language_from_locale (const char *locale,
+                                                               const char *translation);
+char                *ms_locale_names_get_country_from_locale  (const char *locale,
+                                                               const char *translation);
+char                *ms_locale_names_normalize_locale         (const char *locale);
+gboolean             ms_locale_names_parse_locale             (const char  *locale,
+                                                               char       **language_codep,
+                                                               char       **country_codep,
+                                                               char       **codesetp,
+                                                               char       **modifierp);
+
+G_END_DECLS
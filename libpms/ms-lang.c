@@ -11,9 +11,7 @@
 #include "mobile-settings-config.h"
 
 #include "ms-lang.h"
-
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
+#include "lang/ms-locale-names.h"
 
 /**
  * ms_lang_get_language_from_locale:
@@ -23,7 +21,9 @@
  * Gets the language description for @locale. If @translation is
  * provided the returned string is translated accordingly.
  *
- * This just wraps gnome_get_language_from_locale().
+ * Like gnome_get_language_from_locale() but serialized with the
+ * background loading of locale names as gnome-desktop isn't thread
+ * safe.
  *
  * Return value: (transfer full): the language description. Caller
  * takes ownership.
@@ -31,7 +31,7 @@
 char *
 ms_lang_get_language_from_locale (const char *locale, const char *translation)
 {
-  return gnome_get_language_from_locale (locale, translation);
+  return ms_locale_names_get_language_from_locale (locale, translation);
 }
 
 /**
@@ -42,7 +42,9 @@ ms_lang_get_language_from_locale (const char *locale, const char *translation)
  * Gets the country description for @locale. If @translation is
  * provided the returned string is translated accordingly.
  *
- * This just wraps gnome_get_country_from_locale().
+ * Like gnome_get_country_from_locale() but serialized with the
+ * background loading of locale names as gnome-desktop isn't thread
+ * safe.
  *
  * Return value: (transfer full): the country description. Caller
  * takes ownership.
@@ -50,5 +52,18 @@ ms_lang_get_language_from_locale (const char *locale, const char *translation)
 char *
 ms_lang_get_country_from_locale  (const char *locale, const char *translation)
 {
-  return gnome_get_country_from_locale (locale, translation);
+  return ms_locale_names_get_country_from_locale (locale, translation);
+}
+
+/**
+ * ms_lang_prefetch_locale_names:
+ *
+ * Start loading the display names of all locales in the background
+ * so the language chooser doesn't have to wait for them. Call this
+ * early, e.g. once the UI is up.
+ */
+void
+ms_lang_prefetch_locale_names (void)
+{
+  ms_locale_names_ensure ();
 }
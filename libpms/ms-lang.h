@@ -21,5 +21,7 @@ char *ms_lang_get_language_from_locale (const char *locale,
 PMS_AVAILABLE_IN_ALL
 char *ms_lang_get_country_from_locale  (const char *locale,
                                         const char *translation);
+PMS_AVAILABLE_IN_ALL
+void  ms_lang_prefetch_locale_names    (void);
 
 G_END_DECLS
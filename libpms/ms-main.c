@@ -34,16 +34,46 @@ ms_init (void)
   }
 }
 
+/**
+ * ms_get_default_os_updater:
+ *
+ * Get the default os updater. The updater is shared between all
+ * callers and initializes itself asynchronously so this never blocks
+ * on DBus. Check its `supported` property to figure out if it is
+ * actually usable, it is updated once the service was queried.
+ *
+ * Returns:(transfer full): The updater
+ */
+MsOsUpdater *
+ms_get_default_os_updater (void)
+{
+  static MsOsUpdater *updater;
+
+  if (updater)
+    return g_object_ref (updater);
+
+  updater = MS_OS_UPDATER (ms_systemd_sysupdate_new ());
+  g_object_add_weak_pointer (G_OBJECT (updater), (gpointer *) &updater);
+
+  return updater;
+}
+
 /**
  * ms_get_default_os_updater_sync:
  *
- * Get the default os updater. Check it's `supported` property to figure out
- * if it is actually usable
+ * Get the default os updater. Check its `supported` property to figure out
+ * if it is actually usable.
+ *
+ * Despite its name this doesn't wait for the service to be queried
+ * anymore so `supported` is %FALSE until the updater got a reply.
+ *
+ * Deprecated: Use ms_get_default_os_updater() and watch the
+ *   `supported` property instead.
  *
  * Returns:(transfer full): The updater
  */
 MsOsUpdater *
 ms_get_default_os_updater_sync (void)
 {
-  return MS_OS_UPDATER (ms_systemd_sysupdate_new ());
+  return ms_get_default_os_updater ();
 }
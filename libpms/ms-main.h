@@ -20,6 +20,8 @@ PMS_AVAILABLE_IN_ALL
 void ms_init (void);
 
 PMS_AVAILABLE_IN_ALL
+MsOsUpdater *ms_get_default_os_updater (void);
+PMS_AVAILABLE_IN_ALL G_DEPRECATED_FOR (ms_get_default_os_updater)
 MsOsUpdater *ms_get_default_os_updater_sync (void);
 
 G_END_DECLS
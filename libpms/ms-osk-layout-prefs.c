@@ -14,6 +14,7 @@
 #include "ms-osk-layout-prefs.h"
 #include "ms-osk-layout-row-priv.h"
 #include "ms-osk-layout-priv.h"
+#include "lang/ms-locale-names.h"
 
 #include <json-glib/json-glib.h>
 
@@ -700,7 +701,7 @@ ms_osk_layout_prefs_add_for_locale (MsOskLayoutPrefs *self,
   g_return_val_if_fail (MS_IS_OSK_LAYOUT_PREFS (self), FALSE);
   g_return_val_if_fail (locale, FALSE);
 
-  if (!gnome_parse_locale (locale, &lcp, &ccp, NULL, NULL))
+  if (!ms_locale_names_parse_locale (locale, &lcp, &ccp, NULL, NULL))
     return FALSE;
 
   if (!gm_str_is_null_or_empty (lcp) && !gm_str_is_null_or_empty (ccp)) {
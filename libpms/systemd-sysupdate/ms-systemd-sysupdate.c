@@ -704,8 +704,9 @@ on_job_removed (MsSystemdSysupdate *self, guint64 job_id, const char *job_path,
 
 
 static void
-check_service (MsSystemdSysupdate *self)
+on_list_targets_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+  MsSystemdSysupdate *self;
   g_autoptr (GError) err = NULL;
   const char *class = NULL;
   const char *name = NULL;
@@ -714,36 +715,21 @@ check_service (MsSystemdSysupdate *self)
   g_autoptr (GVariantIter) variant_iter = NULL;
   gboolean success;
 
-  self->manager = ms_dbus_sysupdate_manager_proxy_new_sync (self->bus,
-                                                            G_DBUS_PROXY_FLAGS_NONE,
-                                                            "org.freedesktop.sysupdate1",
-                                                            "/org/freedesktop/sysupdate1",
-                                                            NULL,
-                                                            &err);
-  if (self->manager == NULL) {
-    g_debug ("Failed to get sysupdate_proxy: %s", err->message);
-    ms_os_updater_set_supported (MS_OS_UPDATER (self), FALSE);
-    return;
-  }
-
-  g_signal_connect_object (self->manager,
-                           "job-removed",
-                           G_CALLBACK (on_job_removed),
-                           self,
-                           G_CONNECT_SWAPPED);
-
-  success = ms_dbus_sysupdate_manager_call_list_targets_sync (self->manager,
-                                                              G_DBUS_CALL_FLAGS_NONE,
-                                                              10000,
-                                                              &ret_targets,
-                                                              NULL,
-                                                              &err);
+  success = ms_dbus_sysupdate_manager_call_list_targets_finish (MS_DBUS_SYSUPDATE_MANAGER (source_object),
+                                                                &ret_targets,
+                                                                res,
+                                                                &err);
   if (!success) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    self = MS_SYSTEMD_SYSUPDATE (user_data);
     g_debug ("Failed to list sysupdate targets: %s", err->message);
     ms_os_updater_set_supported (MS_OS_UPDATER (self), FALSE);
     return;
   }
 
+  self = MS_SYSTEMD_SYSUPDATE (user_data);
   g_variant_get (ret_targets, "a(sso)", &variant_iter);
   /* Get info about all the targets */
   while (g_variant_iter_loop (variant_iter, "(&s&s&o)", &class, &name, &object_path)) {
@@ -774,6 +760,67 @@ check_service (MsSystemdSysupdate *self)
 }
 
 
+static void
+on_manager_proxy_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsSystemdSysupdate *self;
+  MsDBusSysupdateManager *manager;
+  g_autoptr (GError) err = NULL;
+
+  manager = ms_dbus_sysupdate_manager_proxy_new_finish (res, &err);
+  if (manager == NULL) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    self = MS_SYSTEMD_SYSUPDATE (user_data);
+    g_debug ("Failed to get sysupdate_proxy: %s", err->message);
+    ms_os_updater_set_supported (MS_OS_UPDATER (self), FALSE);
+    return;
+  }
+
+  self = MS_SYSTEMD_SYSUPDATE (user_data);
+  self->manager = manager;
+
+  g_signal_connect_object (self->manager,
+                           "job-removed",
+                           G_CALLBACK (on_job_removed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  ms_dbus_sysupdate_manager_call_list_targets (self->manager,
+                                               G_DBUS_CALL_FLAGS_NONE,
+                                               10000,
+                                               self->cancel,
+                                               on_list_targets_ready,
+                                               self);
+}
+
+
+static void
+on_bus_get_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsSystemdSysupdate *self;
+  GDBusConnection *bus;
+  g_autoptr (GError) err = NULL;
+
+  bus = g_bus_get_finish (res, &err);
+  if (bus == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_debug ("sysupdate: Can't connect to dbus: %s", err->message);
+    return;
+  }
+
+  self = MS_SYSTEMD_SYSUPDATE (user_data);
+  self->bus = bus;
+
+  ms_dbus_sysupdate_manager_proxy_new (self->bus,
+                                       G_DBUS_PROXY_FLAGS_NONE,
+                                       "org.freedesktop.sysupdate1",
+                                       "/org/freedesktop/sysupdate1",
+                                       self->cancel,
+                                       on_manager_proxy_ready,
+                                       self);
+}
 
 
 static void
@@ -813,16 +860,12 @@ ms_systemd_sysupdate_class_init (MsSystemdSysupdateClass *klass)
 static void
 ms_systemd_sysupdate_init (MsSystemdSysupdate *self)
 {
-  g_autoptr (GError) err = NULL;
   self->cancel = g_cancellable_new ();
-  self->bus = g_bus_get_sync (MS_DBUS_BUS, NULL, &err);
   self->targets = g_ptr_array_new_with_free_func ((GDestroyNotify)target_destroy);
   self->finished_jobs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-  if (self->bus)
-    check_service (self);
-  else
-    g_debug ("sysupdate: Can't connect to dbus");
+  /* Never block on the system bus, `supported` is updated once we know */
+  g_bus_get (MS_DBUS_BUS, self->cancel, on_bus_get_ready, self);
 }
 
 
@@ -8,6 +8,7 @@
  */
 
 #include "ms-plugin-librem5-panel.h"
+#include "ms-plugin-librem5-temp-graph.h"
 #include "ms-util.h"
 
 #include "dbus/login1-manager-dbus.h"
@@ -16,13 +17,22 @@
 
 #include <glib/gi18n.h>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #define CMDLINE_PATH "/proc/cmdline"
 #define CMDLINE_MAX  1024
 
 #define LOGIN_BUS_NAME "org.freedesktop.login1"
 #define LOGIN_OBJECT_PATH "/org/freedesktop/login1"
 
-static uint sensors_inited;
+#define NO_TEMP MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE
+/* Sample less often while temperatures are stable */
+#define MIN_INTERVAL_S 1
+#define MAX_INTERVAL_S 8
+#define STABLE_DELTA 500 /* m°C */
+#define STABLE_SAMPLES 5
 
 typedef enum {
   MS_TEMP_SENSOR_CPU = 0,
@@ -34,9 +44,9 @@ typedef enum {
 } MsTempSensor;
 
 typedef struct {
-  const sensors_chip_name  *name;
-  const sensors_subfeature *subfeature_temp;
-  const sensors_subfeature *subfeature_temp_crit;
+  int       fd;
+  int       crit;  /* m°C, 0 if unknown */
+  int       temp;  /* m°C, as displayed */
   GtkLabel *label;
   GtkImage *icon;
   AdwActionRow *row;
@@ -61,7 +71,10 @@ struct _MsPluginLibrem5Panel {
   GtkLabel      *uboot_label;
 
   MsSensor       temp_sensors[MS_TEMP_SENSOR_LAST + 1];
+  MsPluginLibrem5TempGraph *temp_graph;
   guint          update_timeout_id;
+  guint          interval;
+  guint          n_stable;
 
   GtkWidget                       *suspend_button;
   GCancellable                    *cancel;
@@ -187,52 +200,139 @@ parse_uboot_version (MsPluginLibrem5Panel *self)
 
 
 static gboolean
-on_update_timeout (gpointer user_data)
+read_temp (int fd, int *temp)
 {
-  MsPluginLibrem5Panel *self = MS_PLUGIN_LIBREM5_PANEL (user_data);
-  double temp = 0.0, crit = 0.0;
+  char buf[32];
+  ssize_t len;
+  char *end;
+  gint64 val;
+
+  /* hwmon attributes are regenerated on every read from offset 0 */
+  len = pread (fd, buf, sizeof (buf) - 1, 0);
+  if (len <= 0)
+    return FALSE;
+
+  buf[len] = '\0';
+  val = g_ascii_strtoll (buf, &end, 10);
+  if (end == buf)
+    return FALSE;
+
+  *temp = CLAMP (val, NO_TEMP + 1, G_MAXINT);
+  return TRUE;
+}
+
+
+static void
+update_sensor (MsSensor *sensor, int temp)
+{
+  g_autofree char *temp_msg = NULL;
+
+  /* The label shows hundredths of a degree */
+  if (sensor->temp != NO_TEMP && sensor->temp / 10 == temp / 10)
+    return;
+
+  sensor->temp = temp;
+
+  temp_msg = g_strdup_printf ("%.2f°C", temp / 1000.0);
+  gtk_label_set_label (sensor->label, temp_msg);
+
+  gtk_widget_set_visible (GTK_WIDGET (sensor->icon), sensor->crit && temp >= sensor->crit * 0.9);
+}
+
+
+static void
+sample_sensors (MsPluginLibrem5Panel *self)
+{
+  int temps[MS_TEMP_SENSOR_LAST + 1];
+  gboolean stable = TRUE;
 
   for (MsTempSensor i = 0; i <= MS_TEMP_SENSOR_LAST; i++) {
-    g_autofree char *temp_msg = NULL;
-    g_autofree char *crit_msg = NULL;
-    gboolean icon_visible = FALSE;
+    MsSensor *sensor = &self->temp_sensors[i];
+    int temp;
 
-    if (self->temp_sensors[i].name == NULL)
+    temps[i] = NO_TEMP;
+    if (sensor->fd < 0)
       continue;
 
-    if (sensors_get_value (self->temp_sensors[i].name,
-                           self->temp_sensors[i].subfeature_temp->number, &temp) < 0) {
-      g_warning ("Failed to read temp for %s", self->temp_sensors[i].name->prefix);
+    if (!read_temp (sensor->fd, &temp)) {
+      if (sensor->temp != NO_TEMP)
+        g_warning ("Failed to read temp for %s", temp_sensor_mapping[i].name);
+      sensor->temp = NO_TEMP;
       continue;
     }
 
-    temp_msg = g_strdup_printf ("%.2f°C", temp);
-    gtk_label_set_label (self->temp_sensors[i].label, temp_msg);
+    if (sensor->temp == NO_TEMP || ABS (temp - sensor->temp) >= STABLE_DELTA)
+      stable = FALSE;
 
-    if (self->temp_sensors[i].subfeature_temp_crit &&
-        sensors_get_value (self->temp_sensors[i].name,
-                           self->temp_sensors[i].subfeature_temp_crit->number, &crit) == 0) {
-      crit_msg = g_strdup_printf (_("Critical temperature is %.2f°C"), crit);
-      adw_action_row_set_subtitle (self->temp_sensors[i].row, crit_msg);
-    }
+    temps[i] = temp;
+    update_sensor (sensor, temp);
+  }
 
-    if (temp >= crit * 0.9)
-      icon_visible = TRUE;
+  ms_plugin_librem5_temp_graph_push (self->temp_graph, g_get_monotonic_time (), temps);
 
-    gtk_widget_set_visible (GTK_WIDGET (self->temp_sensors[i].icon), icon_visible);
+  if (!stable) {
+    self->n_stable = 0;
+    self->interval = MIN_INTERVAL_S;
+  } else if (++self->n_stable == STABLE_SAMPLES) {
+    self->n_stable = 0;
+    self->interval = MIN (self->interval * 2, MAX_INTERVAL_S);
   }
+}
 
-  return TRUE;
+
+static gboolean on_update_timeout (gpointer user_data);
+
+
+static void
+schedule_update (MsPluginLibrem5Panel *self)
+{
+  g_clear_handle_id (&self->update_timeout_id, g_source_remove);
+
+  g_debug ("Sampling temperatures every %us", self->interval);
+  self->update_timeout_id = g_timeout_add_seconds (self->interval, on_update_timeout, self);
+  g_source_set_name_by_id (self->update_timeout_id, "[ms] librem5 temperatures");
+}
+
+
+static gboolean
+on_update_timeout (gpointer user_data)
+{
+  MsPluginLibrem5Panel *self = MS_PLUGIN_LIBREM5_PANEL (user_data);
+  guint interval = self->interval;
+
+  sample_sensors (self);
+
+  if (self->interval == interval)
+    return G_SOURCE_CONTINUE;
+
+  self->update_timeout_id = 0;
+  schedule_update (self);
+  return G_SOURCE_REMOVE;
+}
+
+
+static int
+open_subfeature (const sensors_chip_name *name, const sensors_subfeature *subfeature)
+{
+  g_autofree char *path = g_build_filename (name->path, subfeature->name, NULL);
+  int fd;
+
+  fd = open (path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    g_warning ("Failed to open %s: %s", path, g_strerror (errno));
+
+  return fd;
 }
 
 
 static void
 get_features (MsPluginLibrem5Panel *self, MsTempSensor num, const sensors_chip_name *name)
 {
+  MsSensor *sensor = &self->temp_sensors[num];
   int nr = 0;
   const sensors_feature *feature;
   const sensors_subfeature *subfeature;
-  double val;
+  int fd, val;
 
   do {
     feature = sensors_get_features(name, &nr);
@@ -244,32 +344,62 @@ get_features (MsPluginLibrem5Panel *self, MsTempSensor num, const sensors_chip_n
     if (subfeature == NULL)
       continue;
 
-    if (sensors_get_value (name, subfeature->number, &val) < 0) {
+    fd = open_subfeature (name, subfeature);
+    if (fd < 0)
+      continue;
+
+    if (!read_temp (fd, &val)) {
       g_warning ("Failed tor read value for %s", name->prefix);
+      close (fd);
       continue;
     }
 
-    g_debug ("chip: %s, feature: %s, subfeature: %s, value: %f", name->prefix, feature->name, subfeature->name, val);
-    self->temp_sensors[num].name = name;
-    self->temp_sensors[num].subfeature_temp = subfeature;
+    g_debug ("chip: %s, feature: %s, subfeature: %s, value: %d", name->prefix, feature->name, subfeature->name, val);
+    if (sensor->fd >= 0)
+      close (sensor->fd);
+    sensor->fd = fd;
+    sensor->crit = 0;
 
+    /* The critical temperature doesn't change, read it once */
     subfeature = sensors_get_subfeature (name, feature, SENSORS_SUBFEATURE_TEMP_CRIT);
     if (subfeature != NULL) {
-      self->temp_sensors[num].subfeature_temp_crit = subfeature;
+      fd = open_subfeature (name, subfeature);
+      if (fd >= 0 && read_temp (fd, &val))
+        sensor->crit = val;
+      if (fd >= 0)
+        close (fd);
     }
 
   } while (feature);
+
+  if (sensor->crit) {
+    g_autofree char *crit_msg = NULL;
+
+    crit_msg = g_strdup_printf (_("Critical temperature is %.2f°C"), sensor->crit / 1000.0);
+    adw_action_row_set_subtitle (sensor->row, crit_msg);
+  }
 }
 
 
 static void
 init_sensors (MsPluginLibrem5Panel *self)
 {
+  const char *labels[MS_TEMP_SENSOR_LAST + 2] = { NULL };
   int chipnum = 0;
   const sensors_chip_name *name;
 
-  if (sensors_inited == 0)
-    sensors_init (NULL);
+  for (MsTempSensor i = 0; i <= MS_TEMP_SENSOR_LAST; i++) {
+    self->temp_sensors[i].fd = -1;
+    self->temp_sensors[i].temp = NO_TEMP;
+    labels[i] = adw_preferences_row_get_title (ADW_PREFERENCES_ROW (self->temp_sensors[i].row));
+  }
+  ms_plugin_librem5_temp_graph_set_series (self->temp_graph, labels);
+
+  /* libsensors is only used to find the sensors, they're read via sysfs */
+  if (sensors_init (NULL) != 0) {
+    g_warning ("Failed to initialize libsensors");
+    return;
+  }
 
   do {
     name = sensors_get_detected_chips (NULL, &chipnum);
@@ -283,6 +413,8 @@ init_sensors (MsPluginLibrem5Panel *self)
       }
     }
   } while (name);
+
+  sensors_cleanup ();
 }
 
 
@@ -293,8 +425,10 @@ ms_plugin_librem5_panel_realize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (ms_plugin_librem5_panel_parent_class)->realize (widget);
 
-  self->update_timeout_id = g_timeout_add_seconds (1, on_update_timeout, self);
-  on_update_timeout (self);
+  self->interval = MIN_INTERVAL_S;
+  self->n_stable = 0;
+  sample_sensors (self);
+  schedule_update (self);
 }
 
 
@@ -314,11 +448,9 @@ ms_plugin_librem5_panel_finalize (GObject *object)
 {
   MsPluginLibrem5Panel *self = MS_PLUGIN_LIBREM5_PANEL (object);
 
-  if (sensors_inited) {
-    if (sensors_inited == 1)
-      sensors_cleanup();
-
-    sensors_inited--;
+  for (MsTempSensor i = 0; i <= MS_TEMP_SENSOR_LAST; i++) {
+    if (self->temp_sensors[i].fd >= 0)
+      close (self->temp_sensors[i].fd);
   }
 
   g_cancellable_cancel (self->cancel);
@@ -339,10 +471,13 @@ ms_plugin_librem5_panel_class_init (MsPluginLibrem5PanelClass *klass)
   widget_class->realize = ms_plugin_librem5_panel_realize;
   widget_class->unrealize = ms_plugin_librem5_panel_unrealize;
 
+  g_type_ensure (MS_TYPE_PLUGIN_LIBREM5_TEMP_GRAPH);
+
   gtk_widget_class_set_template_from_resource (widget_class,
                                                "/mobi/phosh/MobileSettings/plugins/librem5/ui/ms-plugin-librem5-panel.ui");
   gtk_widget_class_bind_template_child (widget_class, MsPluginLibrem5Panel, uboot_label);
   gtk_widget_class_bind_template_child (widget_class, MsPluginLibrem5Panel, suspend_button);
+  gtk_widget_class_bind_template_child (widget_class, MsPluginLibrem5Panel, temp_graph);
 
   for (int i = 0; i <= MS_TEMP_SENSOR_LAST; i++) {
     g_autofree char *name_label = g_strdup_printf ("%s_temp_label", temp_sensor_mapping[i].pretty);
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ms-plugin-librem5-temp-graph.h"
+
+/* Enough for the whole span at the highest sampling rate */
+#define HISTORY_LEN 600
+#define GRAPH_SPAN_US (10 * 60 * G_USEC_PER_SEC)
+/* Samples further apart are from different sampling sessions */
+#define MAX_GAP_US (20 * G_USEC_PER_SEC)
+/* Don't blow up sensor noise to the full height */
+#define MIN_RANGE 5000
+#define LEGEND_SPACING 12
+#define LINE_WIDTH 2.0
+
+/**
+ * MsPluginLibrem5TempGraph:
+ *
+ * Plots the most recent temperatures of a fixed set of sensors. The
+ * samples are kept in a fixed size ring buffer, older samples get
+ * dropped.
+ */
+
+static const GdkRGBA palette[] = {
+  { 0.208, 0.518, 0.894, 1.0 },
+  { 0.200, 0.820, 0.478, 1.0 },
+  { 0.965, 0.827, 0.176, 1.0 },
+  { 1.000, 0.471, 0.000, 1.0 },
+  { 0.569, 0.255, 0.675, 1.0 },
+};
+
+struct _MsPluginLibrem5TempGraph {
+  GtkWidget  parent;
+
+  GStrv      labels;
+  guint      n_series;
+
+  /* Ring buffer, values are in m°C */
+  gint64    *times;
+  int       *values;
+  guint      head;
+  guint      n_samples;
+};
+
+G_DEFINE_TYPE (MsPluginLibrem5TempGraph, ms_plugin_librem5_temp_graph, GTK_TYPE_WIDGET)
+
+
+static guint
+get_index (MsPluginLibrem5TempGraph *self, guint i)
+{
+  return (self->head + HISTORY_LEN - self->n_samples + i) % HISTORY_LEN;
+}
+
+
+static gboolean
+get_range (MsPluginLibrem5TempGraph *self, gint64 start, int *min, int *max)
+{
+  *min = G_MAXINT;
+  *max = G_MININT;
+
+  for (guint i = 0; i < self->n_samples; i++) {
+    guint index = get_index (self, i);
+
+    if (self->times[index] < start)
+      continue;
+
+    for (guint s = 0; s < self->n_series; s++) {
+      int value = self->values[index * self->n_series + s];
+
+      if (value == MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE)
+        continue;
+
+      *min = MIN (*min, value);
+      *max = MAX (*max, value);
+    }
+  }
+
+  if (*min > *max)
+    return FALSE;
+
+  /* Full degrees */
+  *min -= (*min % 1000 + 1000) % 1000;
+  *max += (1000 - (*max % 1000 + 1000) % 1000) % 1000;
+  if (*max - *min < MIN_RANGE) {
+    *min -= (MIN_RANGE - (*max - *min)) / 2;
+    *max = *min + MIN_RANGE;
+  }
+
+  return TRUE;
+}
+
+
+static void
+append_series (MsPluginLibrem5TempGraph *self,
+               GtkSnapshot              *snapshot,
+               guint                     series,
+               const graphene_rect_t    *area,
+               gint64                    start,
+               int                       min,
+               int                       max)
+{
+  g_autoptr (GskPathBuilder) builder = gsk_path_builder_new ();
+  g_autoptr (GskPath) path = NULL;
+  g_autoptr (GskStroke) stroke = NULL;
+  gboolean drawing = FALSE;
+  gint64 last = 0;
+
+  for (guint i = 0; i < self->n_samples; i++) {
+    guint index = get_index (self, i);
+    int value = self->values[index * self->n_series + series];
+    gint64 time = self->times[index];
+    float x, y;
+
+    if (time < start)
+      continue;
+
+    if (value == MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE) {
+      drawing = FALSE;
+      continue;
+    }
+
+    x = area->origin.x + (time - start) * area->size.width / GRAPH_SPAN_US;
+    y = area->origin.y + (double) (max - value) * area->size.height / (max - min);
+
+    if (drawing && time - last <= MAX_GAP_US)
+      gsk_path_builder_line_to (builder, x, y);
+    else
+      gsk_path_builder_move_to (builder, x, y);
+
+    drawing = TRUE;
+    last = time;
+  }
+
+  path = gsk_path_builder_to_path (builder);
+  stroke = gsk_stroke_new (LINE_WIDTH);
+  gsk_stroke_set_line_join (stroke, GSK_LINE_JOIN_ROUND);
+  gtk_snapshot_append_stroke (snapshot, path, stroke, &palette[series % G_N_ELEMENTS (palette)]);
+}
+
+
+static void
+append_label (GtkSnapshot   *snapshot,
+              PangoLayout   *layout,
+              float          x,
+              float          y,
+              const GdkRGBA *color)
+{
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
+  gtk_snapshot_append_layout (snapshot, layout, color);
+  gtk_snapshot_restore (snapshot);
+}
+
+
+static void
+ms_plugin_librem5_temp_graph_snapshot (GtkWidget *widget, GtkSnapshot *snapshot)
+{
+  MsPluginLibrem5TempGraph *self = MS_PLUGIN_LIBREM5_TEMP_GRAPH (widget);
+  g_autoptr (PangoLayout) layout = NULL;
+  g_autofree char *min_label = NULL;
+  g_autofree char *max_label = NULL;
+  int width = gtk_widget_get_width (widget);
+  int height = gtk_widget_get_height (widget);
+  int min, max, label_width, label_height, x = 0;
+  graphene_rect_t area;
+  GdkRGBA color;
+  gint64 start;
+
+  if (self->n_samples == 0)
+    return;
+
+  start = self->times[get_index (self, self->n_samples - 1)] - GRAPH_SPAN_US;
+  if (!get_range (self, start, &min, &max))
+    return;
+
+  gtk_widget_get_color (widget, &color);
+  layout = gtk_widget_create_pango_layout (widget, NULL);
+
+  /* The legend on top, one entry per series with data */
+  for (guint s = 0; s < self->n_series; s++) {
+    gboolean has_data = FALSE;
+
+    for (guint i = 0; i < self->n_samples && !has_data; i++) {
+      guint index = get_index (self, i);
+
+      has_data = self->times[index] >= start &&
+        self->values[index * self->n_series + s] != MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE;
+    }
+    if (!has_data)
+      continue;
+
+    pango_layout_set_text (layout, self->labels[s], -1);
+    pango_layout_get_pixel_size (layout, &label_width, NULL);
+    append_label (snapshot, layout, x, 0, &palette[s % G_N_ELEMENTS (palette)]);
+    x += label_width + LEGEND_SPACING;
+  }
+
+  /* The range on the right */
+  max_label = g_strdup_printf ("%d°C", max / 1000);
+  pango_layout_set_text (layout, max_label, -1);
+  pango_layout_get_pixel_size (layout, &label_width, &label_height);
+  append_label (snapshot, layout, width - label_width, label_height, &color);
+
+  min_label = g_strdup_printf ("%d°C", min / 1000);
+  pango_layout_set_text (layout, min_label, -1);
+  pango_layout_get_pixel_size (layout, &label_width, NULL);
+  append_label (snapshot, layout, width - label_width, height - label_height, &color);
+
+  area = GRAPHENE_RECT_INIT (LINE_WIDTH / 2,
+                             label_height + LINE_WIDTH / 2,
+                             width - label_width - LEGEND_SPACING - LINE_WIDTH,
+                             height - label_height - LINE_WIDTH);
+  if (area.size.width <= 0 || area.size.height <= 0)
+    return;
+
+  for (guint s = 0; s < self->n_series; s++)
+    append_series (self, snapshot, s, &area, start, min, max);
+}
+
+
+static void
+ms_plugin_librem5_temp_graph_finalize (GObject *object)
+{
+  MsPluginLibrem5TempGraph *self = MS_PLUGIN_LIBREM5_TEMP_GRAPH (object);
+
+  g_clear_pointer (&self->labels, g_strfreev);
+  g_clear_pointer (&self->times, g_free);
+  g_clear_pointer (&self->values, g_free);
+
+  G_OBJECT_CLASS (ms_plugin_librem5_temp_graph_parent_class)->finalize (object);
+}
+
+
+static void
+ms_plugin_librem5_temp_graph_class_init (MsPluginLibrem5TempGraphClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->finalize = ms_plugin_librem5_temp_graph_finalize;
+  widget_class->snapshot = ms_plugin_librem5_temp_graph_snapshot;
+
+  gtk_widget_class_set_accessible_role (widget_class, GTK_ACCESSIBLE_ROLE_IMG);
+}
+
+
+static void
+ms_plugin_librem5_temp_graph_init (MsPluginLibrem5TempGraph *self)
+{
+  self->times = g_new0 (gint64, HISTORY_LEN);
+}
+
+
+GtkWidget *
+ms_plugin_librem5_temp_graph_new (void)
+{
+  return g_object_new (MS_TYPE_PLUGIN_LIBREM5_TEMP_GRAPH, NULL);
+}
+
+/**
+ * ms_plugin_librem5_temp_graph_set_series:
+ * @self: The temperature graph
+ * @labels: The labels of the series to plot
+ *
+ * Set the series to plot. This drops all samples.
+ */
+void
+ms_plugin_librem5_temp_graph_set_series (MsPluginLibrem5TempGraph *self,
+                                         const char * const       *labels)
+{
+  g_return_if_fail (MS_IS_PLUGIN_LIBREM5_TEMP_GRAPH (self));
+  g_return_if_fail (labels);
+
+  g_strfreev (self->labels);
+  self->labels = g_strdupv ((char **) labels);
+  self->n_series = g_strv_length (self->labels);
+
+  g_free (self->values);
+  self->values = g_new (int, HISTORY_LEN * self->n_series);
+  self->head = 0;
+  self->n_samples = 0;
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+/**
+ * ms_plugin_librem5_temp_graph_push:
+ * @self: The temperature graph
+ * @time: The monotonic time of the sample
+ * @values: The temperatures in m°C, one for each series
+ *
+ * Add a sample, replacing the oldest one once the history is full.
+ * Use `MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE` for series that couldn't
+ * be read.
+ */
+void
+ms_plugin_librem5_temp_graph_push (MsPluginLibrem5TempGraph *self,
+                                   gint64                    time,
+                                   const int                *values)
+{
+  g_return_if_fail (MS_IS_PLUGIN_LIBREM5_TEMP_GRAPH (self));
+  g_return_if_fail (self->n_series > 0);
+  g_return_if_fail (values);
+
+  self->times[self->head] = time;
+  memcpy (&self->values[self->head * self->n_series], values, self->n_series * sizeof (int));
+
+  self->head = (self->head + 1) % HISTORY_LEN;
+  self->n_samples = MIN (self->n_samples + 1, HISTORY_LEN);
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* Marks a series without a value in a sample */
+#define MS_PLUGIN_LIBREM5_TEMP_GRAPH_NO_VALUE G_MININT
+
+#define MS_TYPE_PLUGIN_LIBREM5_TEMP_GRAPH (ms_plugin_librem5_temp_graph_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsPluginLibrem5TempGraph, ms_plugin_librem5_temp_graph, MS, PLUGIN_LIBREM5_TEMP_GRAPH, GtkWidget)
+
+GtkWidget *ms_plugin_librem5_temp_graph_new        (void);
+void       ms_plugin_librem5_temp_graph_set_series (MsPluginLibrem5TempGraph *self,
+                                                    const char * const       *labels);
+void       ms_plugin_librem5_temp_graph_push       (MsPluginLibrem5TempGraph *self,
+                                                    gint64                    time,
+                                                    const int                *values);
+
+G_END_DECLS
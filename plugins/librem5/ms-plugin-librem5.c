@@ -48,3 +48,10 @@ g_io_ms_plugin_librem5_query (void)
 
   return g_strdupv (extension_points);
 }
+
+/* Lets gio-querymodules add us to giomodule.cache so we're only loaded when needed */
+char **
+g_io_module_query (void)
+{
+  return g_io_ms_plugin_librem5_query ();
+}
@@ -11,6 +11,7 @@
 #include "mobile-settings-config.h"
 #include "ms-application.h"
 #include "ms-main.h"
+#include "ms-trace.h"
 
 #include "libpms.h"
 
@@ -34,6 +35,11 @@ main (int argc, char *argv[])
   g_autoptr (GError) err = NULL;
   int ret;
 
+  ms_trace_init ();
+  /* GApplication parses options too late to trace the app's construction */
+  if (g_strv_contains ((const char * const *) argv, "--startup-profile"))
+    ms_trace_set_startup_profile (TRUE);
+
   /* Init libpms */
   ms_init ();
   /* Init the private lib */
@@ -44,6 +50,7 @@ main (int argc, char *argv[])
   ret = g_application_run (G_APPLICATION (app), argc, argv);
 
   ms_internal_uninit ();
+  ms_trace_shutdown ();
 
   return ret;
 }
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-app-info-registry"
+
+#include "mobile-settings-config.h"
+
+#include "ms-app-info-registry.h"
+
+/**
+ * MsAppInfoRegistry:
+ *
+ * Enumerates the installed apps once and indexes them by desktop id,
+ * by lowercase desktop id and by lowercase `StartupWMClass` so app
+ * lookups don't need to hit the file system. Enumeration happens in a
+ * thread. Until it's done lookups fall back to loading the individual
+ * desktop files. The index gets rebuilt when the installed apps change.
+ */
+
+enum {
+  PROP_0,
+  PROP_LOADED,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _MsAppInfoRegistry {
+  GObject          parent;
+
+  gboolean         loaded;
+  GPtrArray       *apps;
+  GHashTable      *by_id;
+  GHashTable      *by_lowercase_id;
+  GHashTable      *by_wm_class;
+
+  GAppInfoMonitor *monitor;
+  GCancellable    *cancel;
+};
+G_DEFINE_TYPE (MsAppInfoRegistry, ms_app_info_registry, G_TYPE_OBJECT)
+
+
+static void load_apps (MsAppInfoRegistry *self);
+
+
+static void
+load_apps_in_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  GPtrArray *apps = g_ptr_array_new_with_free_func (g_object_unref);
+  GList *all_apps = g_app_info_get_all ();
+
+  for (GList *l = all_apps; l; l = l->next) {
+    if (!G_IS_DESKTOP_APP_INFO (l->data))
+      continue;
+
+    g_ptr_array_add (apps, g_object_ref (l->data));
+  }
+  g_list_free_full (all_apps, g_object_unref);
+
+  g_task_return_pointer (task, apps, (GDestroyNotify) g_ptr_array_unref);
+}
+
+
+static void
+index_app (MsAppInfoRegistry *self, GDesktopAppInfo *app_info)
+{
+  const char *id = g_app_info_get_id (G_APP_INFO (app_info));
+  const char *wm_class = g_desktop_app_info_get_startup_wm_class (app_info);
+  g_autofree char *lowercase = NULL;
+
+  if (id == NULL)
+    return;
+
+  g_hash_table_replace (self->by_id, g_strdup (id), app_info);
+
+  /* Prefer ids that are lowercase already over lowercased ones */
+  lowercase = g_utf8_strdown (id, -1);
+  if (g_str_equal (id, lowercase) || !g_hash_table_contains (self->by_lowercase_id, lowercase))
+    g_hash_table_replace (self->by_lowercase_id, g_steal_pointer (&lowercase), app_info);
+
+  if (wm_class)
+    g_hash_table_insert (self->by_wm_class, g_utf8_strdown (wm_class, -1), app_info);
+}
+
+
+static void
+on_apps_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsAppInfoRegistry *self;
+  g_autoptr (GPtrArray) apps = NULL;
+  g_autoptr (GError) err = NULL;
+
+  apps = g_task_propagate_pointer (G_TASK (res), &err);
+  if (apps == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to load apps: %s", err->message);
+    return;
+  }
+
+  self = MS_APP_INFO_REGISTRY (source_object);
+
+  /* The values are owned by self->apps */
+  g_hash_table_remove_all (self->by_id);
+  g_hash_table_remove_all (self->by_lowercase_id);
+  g_hash_table_remove_all (self->by_wm_class);
+  g_clear_pointer (&self->apps, g_ptr_array_unref);
+
+  self->apps = g_steal_pointer (&apps);
+  for (guint i = 0; i < self->apps->len; i++)
+    index_app (self, g_ptr_array_index (self->apps, i));
+
+  g_debug ("Indexed %u apps", self->apps->len);
+
+  if (!self->loaded) {
+    self->loaded = TRUE;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOADED]);
+  }
+  g_signal_emit (self, signals[CHANGED], 0);
+}
+
+
+static void
+load_apps (MsAppInfoRegistry *self)
+{
+  g_autoptr (GTask) task = NULL;
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  self->cancel = g_cancellable_new ();
+
+  task = g_task_new (self, self->cancel, on_apps_loaded, NULL);
+  g_task_set_source_tag (task, load_apps);
+  g_task_run_in_thread (task, load_apps_in_thread);
+}
+
+
+static void
+ms_app_info_registry_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  MsAppInfoRegistry *self = MS_APP_INFO_REGISTRY (object);
+
+  switch (property_id) {
+  case PROP_LOADED:
+    g_value_set_boolean (value, self->loaded);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_app_info_registry_dispose (GObject *object)
+{
+  MsAppInfoRegistry *self = MS_APP_INFO_REGISTRY (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (ms_app_info_registry_parent_class)->dispose (object);
+}
+
+
+static void
+ms_app_info_registry_finalize (GObject *object)
+{
+  MsAppInfoRegistry *self = MS_APP_INFO_REGISTRY (object);
+
+  g_clear_pointer (&self->by_id, g_hash_table_unref);
+  g_clear_pointer (&self->by_lowercase_id, g_hash_table_unref);
+  g_clear_pointer (&self->by_wm_class, g_hash_table_unref);
+  g_clear_pointer (&self->apps, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (ms_app_info_registry_parent_class)->finalize (object);
+}
+
+
+static void
+ms_app_info_registry_class_init (MsAppInfoRegistryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = ms_app_info_registry_get_property;
+  object_class->dispose = ms_app_info_registry_dispose;
+  object_class->finalize = ms_app_info_registry_finalize;
+
+  /**
+   * MsAppInfoRegistry:loaded:
+   *
+   * Whether the installed apps were enumerated
+   */
+  props[PROP_LOADED] =
+    g_param_spec_boolean ("loaded", "", "",
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * MsAppInfoRegistry::changed:
+   *
+   * The set of installed apps was (re)loaded.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   0);
+}
+
+
+static void
+ms_app_info_registry_init (MsAppInfoRegistry *self)
+{
+  self->apps = g_ptr_array_new_with_free_func (g_object_unref);
+  self->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->by_lowercase_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->by_wm_class = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  self->monitor = g_app_info_monitor_get ();
+  g_signal_connect_object (self->monitor,
+                           "changed",
+                           G_CALLBACK (load_apps),
+                           self,
+                           G_CONNECT_SWAPPED);
+  load_apps (self);
+}
+
+/**
+ * ms_app_info_registry_get_default:
+ *
+ * Get the application wide registry. It must only be used from the
+ * main thread.
+ *
+ * Returns:(transfer none): The registry
+ */
+MsAppInfoRegistry *
+ms_app_info_registry_get_default (void)
+{
+  static MsAppInfoRegistry *instance;
+
+  if (instance == NULL)
+    instance = g_object_new (MS_TYPE_APP_INFO_REGISTRY, NULL);
+
+  return instance;
+}
+
+
+gboolean
+ms_app_info_registry_get_loaded (MsAppInfoRegistry *self)
+{
+  g_return_val_if_fail (MS_IS_APP_INFO_REGISTRY (self), FALSE);
+
+  return self->loaded;
+}
+
+/**
+ * ms_app_info_registry_lookup:
+ * @self: The registry
+ * @desktop_id: The desktop id, e.g. `org.gnome.Maps.desktop`
+ *
+ * Look up an app by its desktop id.
+ *
+ * Returns:(transfer none)(nullable): The app info
+ */
+GDesktopAppInfo *
+ms_app_info_registry_lookup (MsAppInfoRegistry *self, const char *desktop_id)
+{
+  GDesktopAppInfo *app_info;
+
+  g_return_val_if_fail (MS_IS_APP_INFO_REGISTRY (self), NULL);
+  g_return_val_if_fail (desktop_id, NULL);
+
+  app_info = g_hash_table_lookup (self->by_id, desktop_id);
+  if (app_info || self->loaded)
+    return app_info;
+
+  /* Not enumerated yet, look at the desktop file directly */
+  app_info = g_desktop_app_info_new (desktop_id);
+  if (app_info == NULL)
+    return NULL;
+
+  g_ptr_array_add (self->apps, app_info);
+  index_app (self, app_info);
+
+  return app_info;
+}
+
+
+static GDesktopAppInfo *
+lookup_desktop_id (MsAppInfoRegistry *self, const char *name, gboolean lowercase)
+{
+  g_autofree char *desktop_id = g_strdup_printf ("%s.desktop", name);
+
+  if (lowercase && self->loaded)
+    return g_hash_table_lookup (self->by_lowercase_id, desktop_id);
+
+  return ms_app_info_registry_lookup (self, desktop_id);
+}
+
+/**
+ * ms_app_info_registry_lookup_app_id:
+ * @self: The registry
+ * @app_id: The app id as e.g. used by Wayland toplevels
+ *
+ * Look up an app by an app id. This is based on what phosh does and
+ * also handles app ids that are rev-DNS while the desktop file is not
+ * and X11 `WM_CLASS` values.
+ *
+ * Returns:(transfer none)(nullable): The app info
+ */
+GDesktopAppInfo *
+ms_app_info_registry_lookup_app_id (MsAppInfoRegistry *self, const char *app_id)
+{
+  g_autofree char *lowercase = NULL;
+  GDesktopAppInfo *app_info;
+  const char *last_component;
+  static const char *mappings[][2] = {
+    { "org.gnome.ControlCenter", "gnome-control-center" },
+    { "gnome-usage", "org.gnome.Usage" },
+  };
+
+  g_return_val_if_fail (MS_IS_APP_INFO_REGISTRY (self), NULL);
+  g_return_val_if_fail (app_id, NULL);
+
+  /* fix up applications with known broken app-id */
+  for (guint i = 0; i < G_N_ELEMENTS (mappings); i++) {
+    if (strcmp (app_id, mappings[i][0]) == 0) {
+      app_id = mappings[i][1];
+      break;
+    }
+  }
+
+  app_info = lookup_desktop_id (self, app_id, FALSE);
+  if (app_info)
+    return app_info;
+
+  /* try to handle the case where app-id is rev-DNS, but desktop file is not */
+  last_component = strrchr (app_id, '.');
+  if (last_component) {
+    app_info = lookup_desktop_id (self, last_component + 1, FALSE);
+    if (app_info)
+      return app_info;
+  }
+
+  /* X11 WM_CLASS is often capitalized, so try in lowercase as well */
+  lowercase = g_utf8_strdown (last_component ? last_component + 1 : app_id, -1);
+  app_info = lookup_desktop_id (self, lowercase, TRUE);
+  if (app_info)
+    return app_info;
+
+  if (self->loaded) {
+    g_autofree char *wm_class = g_utf8_strdown (app_id, -1);
+
+    app_info = g_hash_table_lookup (self->by_wm_class, wm_class);
+  }
+
+  if (app_info == NULL)
+    g_message ("Could not find application for app-id '%s'", app_id);
+
+  return app_info;
+}
+
+/**
+ * ms_app_info_registry_dup_all:
+ * @self: The registry
+ *
+ * Get all known apps. The app infos are immutable so the result can be
+ * handed to a worker thread.
+ *
+ * Returns:(transfer full): The apps
+ */
+GPtrArray *
+ms_app_info_registry_dup_all (MsAppInfoRegistry *self)
+{
+  g_return_val_if_fail (MS_IS_APP_INFO_REGISTRY (self), NULL);
+
+  return g_ptr_array_copy (self->apps, (GCopyFunc) g_object_ref, NULL);
+}
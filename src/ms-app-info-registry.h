@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gdesktopappinfo.h>
+
+G_BEGIN_DECLS
+
+#define MS_TYPE_APP_INFO_REGISTRY (ms_app_info_registry_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsAppInfoRegistry, ms_app_info_registry, MS, APP_INFO_REGISTRY, GObject)
+
+MsAppInfoRegistry *ms_app_info_registry_get_default     (void);
+gboolean           ms_app_info_registry_get_loaded      (MsAppInfoRegistry *self);
+GDesktopAppInfo   *ms_app_info_registry_lookup          (MsAppInfoRegistry *self,
+                                                         const char        *desktop_id);
+GDesktopAppInfo   *ms_app_info_registry_lookup_app_id   (MsAppInfoRegistry *self,
+                                                         const char        *app_id);
+GPtrArray         *ms_app_info_registry_dup_all         (MsAppInfoRegistry *self);
+
+G_END_DECLS
@@ -12,6 +12,7 @@
 #include "mobile-settings-config.h"
 
 #include "ms-application.h"
+#include "ms-benchmark.h"
 #include "ms-window.h"
 #include "ms-plugin.h"
 #include "ms-plugin-loader.h"
@@ -19,6 +20,8 @@
 #include "ms-head-tracker.h"
 #include "ms-debug-info.h"
 #include "ms-panel.h"
+#include "ms-trace.h"
+#include "ms-util.h"
 
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 #include "wlr-output-management-unstable-v1-client-protocol.h"
@@ -62,6 +65,13 @@ struct _MsApplication {
   GHashTable        *wayland_protocols;
 
   GtkWidget         *active_panel;
+
+  /* Resident mode */
+  GSettings         *settings;
+  gboolean           resident;
+  GMemoryMonitor    *memory_monitor;
+
+  char              *benchmark_file;
 };
 
 G_DEFINE_TYPE (MsApplication, ms_application, ADW_TYPE_APPLICATION)
@@ -85,6 +95,16 @@ static const GOptionEntry entries[] = {
     G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE,
     NULL, "List the available panels", NULL
   },
+  {
+    "startup-profile", 0,
+    G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE,
+    NULL, "Print a breakdown of the startup time", NULL
+  },
+  {
+    "benchmark", 0,
+    G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_FILENAME,
+    NULL, "Show all panels in turn and write timing and memory use to FILE", "FILE"
+  },
   {
     "only-conf-tweaks", 'c',
     G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE,
@@ -225,6 +245,21 @@ transform_to_active_panel (GBinding     *binding,
 }
 
 
+static void
+on_window_hidden (MsApplication *self, GtkWidget *window)
+{
+  guint released;
+
+  if (!self->resident)
+    return;
+
+  /* Keep the process around but give back what's cheap to rebuild */
+  released = ms_window_release_panels (MS_WINDOW (window), TRUE);
+  ms_util_trim_memory ();
+  g_debug ("Window hidden, released %u panels", released);
+}
+
+
 static GtkWindow *
 get_active_window (MsApplication *self)
 {
@@ -233,8 +268,10 @@ get_active_window (MsApplication *self)
   if (window == NULL) {
     AdwViewStack *panel_stack;
     MsPanelSwitcher *panel_switcher;
+    gint64 begin = ms_trace_begin ();
 
     window = g_object_new (MS_TYPE_WINDOW, "application", self, NULL);
+    ms_trace_end (begin, "window", NULL);
     panel_switcher = ms_window_get_panel_switcher (MS_WINDOW (window));
     panel_stack = ms_panel_switcher_get_stack (panel_switcher);
 
@@ -244,6 +281,17 @@ get_active_window (MsApplication *self)
                                  G_BINDING_DEFAULT | G_BINDING_SYNC_CREATE,
                                  transform_to_active_panel, NULL,
                                  NULL, NULL);
+
+    if (self->settings) {
+      g_settings_bind (self->settings, "resident-mode",
+                       window, "hide-on-close",
+                       G_SETTINGS_BIND_GET);
+    }
+    g_signal_connect_object (window,
+                             "hide",
+                             G_CALLBACK (on_window_hidden),
+                             self,
+                             G_CONNECT_SWAPPED);
   }
 
   return window;
@@ -289,6 +337,7 @@ list_available_panels (GApplication *app)
   adw_init ();
 
   window = g_object_new (MS_TYPE_WINDOW, NULL);
+  ms_window_ensure_device_panel (window);
   list = ms_window_get_stack_pages (window);
 
   g_print ("Available panels:\n");
@@ -322,6 +371,9 @@ set_panel_activated (GSimpleAction *action,
   window = MS_WINDOW (get_active_window (self));
   panel_switcher = ms_window_get_panel_switcher (window);
 
+  if (g_strcmp0 (panel, "device") == 0)
+    ms_window_ensure_device_panel (window);
+
   if (!ms_panel_switcher_set_active_panel_name (panel_switcher, panel))
     g_warning ("Error: panel `%s` not available, launching with default options.", panel);
 
@@ -387,6 +439,11 @@ ms_application_handle_local_options (GApplication *app, GVariantDict *options)
   GApplicationClass *app_class = G_APPLICATION_CLASS (ms_application_parent_class);
   g_autofree char *panel = NULL;
 
+  if (g_variant_dict_contains (options, "startup-profile"))
+    ms_trace_set_startup_profile (TRUE);
+
+  g_variant_dict_lookup (options, "benchmark", "^ay", &self->benchmark_file);
+
   if (g_variant_dict_contains (options, "version")) {
     print_version ();
 
@@ -440,6 +497,12 @@ ms_application_activate (GApplication *app)
   setup_wayland (self);
 
   gtk_window_present (window);
+
+  if (self->benchmark_file) {
+    g_autofree char *benchmark_file = g_steal_pointer (&self->benchmark_file);
+
+    ms_benchmark_run (MS_WINDOW (window), benchmark_file);
+  }
 }
 
 
@@ -449,11 +512,55 @@ static const GActionEntry actions[] = {
 };
 
 
+static void
+on_low_memory_warning (MsApplication              *self,
+                       GMemoryMonitorWarningLevel  level,
+                       GMemoryMonitor             *monitor)
+{
+  GtkWindow *window = gtk_application_get_active_window (GTK_APPLICATION (self));
+  guint released = 0;
+
+  /* Panels in the visible window are handled by the window itself */
+  if (window && !gtk_widget_get_visible (GTK_WIDGET (window)))
+    released = ms_window_release_panels (MS_WINDOW (window), FALSE);
+
+  ms_util_trim_memory ();
+  g_debug ("Low memory warning %d, released %u panels", level, released);
+}
+
+
+static void
+on_resident_mode_changed (MsApplication *self)
+{
+  gboolean resident = g_settings_get_boolean (self->settings, "resident-mode");
+
+  if (resident == self->resident)
+    return;
+
+  self->resident = resident;
+  g_debug ("Resident mode %sabled", resident ? "en" : "dis");
+
+  if (resident) {
+    g_application_hold (G_APPLICATION (self));
+    self->memory_monitor = g_memory_monitor_dup_default ();
+    g_signal_connect_object (self->memory_monitor,
+                             "low-memory-warning",
+                             G_CALLBACK (on_low_memory_warning),
+                             self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    g_clear_object (&self->memory_monitor);
+    g_application_release (G_APPLICATION (self));
+  }
+}
+
+
 static void
 ms_application_startup (GApplication *app)
 {
   g_autoptr (GError) err = NULL;
   MsApplication *self = MS_APPLICATION (app);
+  gint64 begin = ms_trace_begin ();
 
   if (!lfb_init (MOBILE_SETTINGS_APP_ID, &err))
     g_warning ("Failed to init libfeedback: %s", err->message);
@@ -464,12 +571,26 @@ ms_application_startup (GApplication *app)
                                    self);
 
   G_APPLICATION_CLASS (ms_application_parent_class)->startup (app);
+
+  self->settings = g_settings_new ("mobi.phosh.MobileSettings");
+  g_signal_connect_swapped (self->settings,
+                            "changed::resident-mode",
+                            G_CALLBACK (on_resident_mode_changed),
+                            self);
+  on_resident_mode_changed (self);
+
+  ms_trace_end (begin, "startup", NULL);
 }
 
 
 static void
 ms_application_shutdown (GApplication *app)
 {
+  MsApplication *self = MS_APPLICATION (app);
+
+  g_clear_object (&self->memory_monitor);
+  g_clear_object (&self->settings);
+
   G_APPLICATION_CLASS (ms_application_parent_class)->shutdown (app);
 
   lfb_uninit ();
@@ -483,6 +604,7 @@ ms_application_finalize (GObject *object)
 
   g_clear_object (&self->device_plugin_loader);
   g_clear_pointer (&self->wayland_protocols, g_hash_table_destroy);
+  g_clear_pointer (&self->benchmark_file, g_free);
 
 #ifdef MOBILE_SETTINGS_HAVE_GCC_PANELS
   cc_object_storage_destroy ();
@@ -597,10 +719,15 @@ ms_application_init (MsApplication *self)
 GtkWidget *
 ms_application_get_device_panel (MsApplication *self)
 {
+  gint64 begin;
+
   if (self->device_panel)
     return self->device_panel;
 
+  begin = ms_trace_begin ();
   self->device_panel = ms_plugin_loader_load_plugin (self->device_plugin_loader);
+  ms_trace_end (begin, "panel-init", "device");
+
   return self->device_panel;
 }
 
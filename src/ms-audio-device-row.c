@@ -40,21 +40,23 @@ struct _MsAudioDeviceRow {
   GtkAdjustment     *adjustment;
   double             volume;
   gboolean           setting_volume;
+
+  double             pending_volume;
+  guint              push_volume_id;
 };
 G_DEFINE_TYPE (MsAudioDeviceRow, ms_audio_device_row, ADW_TYPE_PREFERENCES_ROW)
 
 
 static void
-on_volume_changed (MsAudioDeviceRow *self)
+push_volume (MsAudioDeviceRow *self)
 {
-  double volume, rounded;
-  g_autofree char *name = NULL;
+  double rounded;
+  gboolean muted;
   GvcMixerStream *stream;
 
-  volume = gtk_adjustment_get_value (self->adjustment);
-  rounded = round (volume);
+  rounded = round (self->pending_volume);
 
-  g_debug ("Setting volume %lf (rounded: %lf) for '%s'", volume, rounded,
+  g_debug ("Setting volume %lf (rounded: %lf) for '%s'", self->pending_volume, rounded,
            ms_audio_device_get_description (self->audio_device));
 
   stream = ms_audio_device_get_stream (self->audio_device);
@@ -63,7 +65,52 @@ on_volume_changed (MsAudioDeviceRow *self)
   if (gvc_mixer_stream_set_volume (stream, (pa_volume_t) rounded) != FALSE)
     gvc_mixer_stream_push_volume (stream);
 
-  gvc_mixer_stream_change_is_muted (stream, (int) rounded == 0);
+  muted = (int) rounded == 0;
+  if (gvc_mixer_stream_get_is_muted (stream) != muted)
+    gvc_mixer_stream_change_is_muted (stream, muted);
+}
+
+
+static gboolean
+on_push_volume_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer unused)
+{
+  MsAudioDeviceRow *self = MS_AUDIO_DEVICE_ROW (widget);
+
+  self->push_volume_id = 0;
+  push_volume (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+flush_volume (MsAudioDeviceRow *self)
+{
+  if (self->push_volume_id == 0)
+    return;
+
+  gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->push_volume_id);
+  self->push_volume_id = 0;
+  push_volume (self);
+}
+
+
+static void
+on_volume_changed (MsAudioDeviceRow *self)
+{
+  /* Dragging the slider changes the value way more often than we
+   * want to talk to the sound server so push at most once per frame */
+  self->pending_volume = gtk_adjustment_get_value (self->adjustment);
+  if (self->push_volume_id)
+    return;
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    self->push_volume_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                         on_push_volume_tick,
+                                                         NULL,
+                                                         NULL);
+  else
+    push_volume (self);
 }
 
 
@@ -108,6 +155,10 @@ on_stream_volume_changed (MsAudioDeviceRow *self)
   if (self->setting_volume)
     return;
 
+  /* A newer value is about to be pushed */
+  if (self->push_volume_id)
+    return;
+
   stream = ms_audio_device_get_stream (self->audio_device);
   g_return_if_fail (stream);
 
@@ -193,12 +244,24 @@ ms_audio_device_row_dispose (GObject *object)
 {
   MsAudioDeviceRow *self = MS_AUDIO_DEVICE_ROW (object);
 
+  if (self->audio_device)
+    flush_volume (self);
   g_clear_object (&self->audio_device);
 
   G_OBJECT_CLASS (ms_audio_device_row_parent_class)->dispose (object);
 }
 
 
+static void
+ms_audio_device_row_unmap (GtkWidget *widget)
+{
+  /* Tick callbacks don't run when unmapped */
+  flush_volume (MS_AUDIO_DEVICE_ROW (widget));
+
+  GTK_WIDGET_CLASS (ms_audio_device_row_parent_class)->unmap (widget);
+}
+
+
 static void
 ms_audio_device_row_class_init (MsAudioDeviceRowClass *klass)
 {
@@ -209,6 +272,8 @@ ms_audio_device_row_class_init (MsAudioDeviceRowClass *klass)
   object_class->set_property = ms_audio_device_row_set_property;
   object_class->dispose = ms_audio_device_row_dispose;
 
+  widget_class->unmap = ms_audio_device_row_unmap;
+
   props[PROP_AUDIO_DEVICE] =
     g_param_spec_object ("audio-device", "", "",
                          MS_TYPE_AUDIO_DEVICE,
@@ -12,6 +12,7 @@
 
 #include "ms-audio-device.h"
 #include "ms-audio-devices.h"
+#include "ms-indexed-list-store.h"
 
 #include "gvc-mixer-control.h"
 
@@ -19,11 +20,17 @@
 #include <glib/gi18n.h>
 #include <gio/gio.h>
 
+/* Keep infos of removed devices around for reconnects, but not forever */
+#define INFO_CACHE_MAX 32
+
 /**
  * MsAudioDevices:
  *
  * The currently available audio devices as a list model. These are
  * not real hardware but rather Pipewire looback's with media roles.
+ *
+ * Devices added or removed within one main loop iteration are applied
+ * to the model at once.
  */
 
 enum {
@@ -36,13 +43,38 @@ enum {
 static GParamSpec *props[PROP_LAST_PROP];
 
 
-struct _MsAudioDevices {
-  GObject          parent;
+typedef struct {
+  gboolean     ignored;
+  guint        stream_id;
+  char        *icon_name;
+  char        *description;
+  MsMediaRole  role;
+} MsAudioDeviceInfo;
+
+
+static const struct {
+  const char  *name;
+  const char  *description;
+  MsMediaRole  role;
+} media_roles[] = {
+  { "input.loopback.sink.role.multimedia", N_("Media Volume"), MS_MEDIA_ROLE_MULTIMEDIA },
+  { "input.loopback.sink.role.notification", N_("Notification Volume"), MS_MEDIA_ROLE_NOTIFICATION },
+  { "input.loopback.sink.role.phone", N_("Voice Call Volume"), MS_MEDIA_ROLE_PHONE },
+  { "input.loopback.sink.role.ringtone", N_("Ring Tone Volume"), MS_MEDIA_ROLE_RINGTONE },
+  { "input.loopback.sink.role.alarm", N_("Alarm Volume"), MS_MEDIA_ROLE_ALARM },
+  { "input.loopback.sink.role.alert", N_("Emergency Alerts Volume"), MS_MEDIA_ROLE_ALERT },
+};
+
 
-  GListStore      *devices;
-  gboolean         is_input;
-  gboolean         has_devices;
-  GvcMixerControl *mixer_control;
+struct _MsAudioDevices {
+  GObject             parent;
+
+  MsIndexedListStore *devices;
+  /* id → MsAudioDeviceInfo, kept across removal for cheap reconnects */
+  GHashTable         *info_cache;
+  gboolean            is_input;
+  gboolean            has_devices;
+  GvcMixerControl    *mixer_control;
 };
 
 static void ms_list_model_iface_init (GListModelInterface *iface);
@@ -132,16 +164,65 @@ ms_list_model_iface_init (GListModelInterface *iface)
 
 
 static void
-on_device_added (MsAudioDevices *self, guint id)
+ms_audio_device_info_free (MsAudioDeviceInfo *info)
 {
-  GvcMixerUIDevice *device = NULL;
-  GvcMixerStream *stream = NULL;
-  g_autofree char *description = NULL;
-  const char *icon_name;
+  g_free (info->icon_name);
+  g_free (info->description);
+  g_free (info);
+}
+
+
+static MsAudioDeviceInfo *
+resolve_device_info (MsAudioDevices *self, GvcMixerUIDevice *device, GvcMixerStream *stream)
+{
+  MsAudioDeviceInfo *info = g_new0 (MsAudioDeviceInfo, 1);
   const char *origin;
   const char *name;
-  MsMediaRole role;
-  g_autoptr (MsAudioDevice) audio_device = NULL;
+  const char *icon_name;
+
+  info->stream_id = gvc_mixer_stream_get_id (stream);
+
+  /* Our loopback devices have empty origin so ignore all others */
+  origin = gvc_mixer_ui_device_get_origin (device);
+  if (!gm_str_is_null_or_empty (origin)) {
+    info->ignored = TRUE;
+    return info;
+  }
+
+  /* Only list the loopback sinks */
+  name = gvc_mixer_stream_get_name (stream);
+  if (!g_str_has_prefix (name, "input.loopback.sink.role.")) {
+    info->ignored = TRUE;
+    return info;
+  }
+
+  icon_name = gvc_mixer_stream_get_icon_name (stream);
+  info->icon_name = g_strdup (icon_name ?: "audio-speakers-symbolic");
+
+  for (guint i = 0; i < G_N_ELEMENTS (media_roles); i++) {
+    if (g_str_equal (name, media_roles[i].name)) {
+      info->description = g_strdup (_(media_roles[i].description));
+      info->role = media_roles[i].role;
+      return info;
+    }
+  }
+
+  g_warning ("Unknown stream name '%s'", name);
+  info->description = g_strdup (gvc_mixer_ui_device_get_description (device));
+  info->role = MS_MEDIA_ROLE_DEFAULT;
+
+  return info;
+}
+
+
+static gpointer
+create_device (gconstpointer key, gpointer user_data)
+{
+  MsAudioDevices *self = MS_AUDIO_DEVICES (user_data);
+  guint id = GPOINTER_TO_UINT (key);
+  GvcMixerUIDevice *device = NULL;
+  GvcMixerStream *stream = NULL;
+  MsAudioDeviceInfo *info;
   guint stream_id;
 
   if (self->is_input)
@@ -151,74 +232,65 @@ on_device_added (MsAudioDevices *self, guint id)
 
   if (device == NULL) {
     g_debug ("No device for id %u", id);
-    return;
+    return NULL;
   }
 
-  /* Our loopback devices have empty origin so ignore all others */
-  origin = gvc_mixer_ui_device_get_origin (device);
-  if (!gm_str_is_null_or_empty (origin))
-    return;
-
   stream_id = gvc_mixer_ui_device_get_stream_id (device);
   stream = gvc_mixer_control_lookup_stream_id (self->mixer_control, stream_id);
   if (!stream) {
     g_debug ("No stream for id %u", stream_id);
-    return;
+    return NULL;
   }
 
-  /* Only list the loopback sinks */
-  name = gvc_mixer_stream_get_name (stream);
-  if (!g_str_has_prefix (name, "input.loopback.sink.role."))
+  /* The id might have been reused for a different stream */
+  info = g_hash_table_lookup (self->info_cache, GUINT_TO_POINTER (id));
+  if (info == NULL || info->stream_id != stream_id) {
+    info = resolve_device_info (self, device, stream);
+    g_hash_table_insert (self->info_cache, GUINT_TO_POINTER (id), info);
+  }
+
+  if (info->ignored)
+    return NULL;
+
+  g_debug ("Adding audio device %u: %s", id, info->description);
+
+  return ms_audio_device_new (id, stream, info->icon_name, info->description, info->role);
+}
+
+
+static gboolean
+is_unused_info (gpointer key, gpointer value, gpointer user_data)
+{
+  MsAudioDevices *self = MS_AUDIO_DEVICES (user_data);
+
+  return !ms_indexed_list_store_contains (self->devices, key);
+}
+
+
+static void
+prune_info_cache (MsAudioDevices *self)
+{
+  guint pruned;
+
+  if (g_hash_table_size (self->info_cache) <= INFO_CACHE_MAX)
     return;
 
-  icon_name = gvc_mixer_stream_get_icon_name (stream);
-  if (!icon_name)
-    icon_name = "audio-speakers-symbolic";
-
-  if (g_str_equal (name, "input.loopback.sink.role.multimedia")) {
-    description = g_strdup (_("Media Volume"));
-    role = MS_MEDIA_ROLE_MULTIMEDIA;
-  } else if (g_str_equal (name, "input.loopback.sink.role.notification")) {
-    description = g_strdup (_("Notification Volume"));
-    role = MS_MEDIA_ROLE_NOTIFICATION;
-  } else if (g_str_equal (name, "input.loopback.sink.role.phone")) {
-    description = g_strdup (_("Voice Call Volume"));
-    role = MS_MEDIA_ROLE_PHONE;
-  } else if (g_str_equal (name, "input.loopback.sink.role.ringtone")) {
-    description = g_strdup (_("Ring Tone Volume"));
-    role = MS_MEDIA_ROLE_RINGTONE;
-  } else if (g_str_equal (name, "input.loopback.sink.role.alarm")) {
-    description = g_strdup (_("Alarm Volume"));
-    role = MS_MEDIA_ROLE_ALARM;
-  } else if (g_str_equal (name, "input.loopback.sink.role.alert")) {
-    description = g_strdup (_("Emergency Alerts Volume"));
-    role = MS_MEDIA_ROLE_ALERT;
-  } else {
-    g_warning ("Unknown stream name '%s'", name);
-    description = g_strdup (gvc_mixer_ui_device_get_description (device));
-    role = MS_MEDIA_ROLE_DEFAULT;
-  }
+  pruned = g_hash_table_foreach_remove (self->info_cache, is_unused_info, self);
+  g_debug ("Pruned %u cached device infos", pruned);
+}
 
-  g_debug ("Adding audio device %d: %s", id, description);
 
-  audio_device = ms_audio_device_new (id, stream, icon_name, description, role);
-  g_list_store_append (self->devices, audio_device);
+static void
+on_device_added (MsAudioDevices *self, guint id)
+{
+  ms_indexed_list_store_add (self->devices, GUINT_TO_POINTER (id));
 }
 
 
 static void
 on_device_removed (MsAudioDevices *self, guint id)
 {
-  g_debug ("Removing audio device %d", id);
-  for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->devices)); i++) {
-    g_autoptr (MsAudioDevice) device = g_list_model_get_item (G_LIST_MODEL (self->devices), i);
-
-    if (id == ms_audio_device_get_id (device)) {
-      g_list_store_remove (self->devices, i);
-      return;
-    }
-  }
-  g_debug ("Device %u not present, can't remove", id);
+  ms_indexed_list_store_remove (self->devices, GUINT_TO_POINTER (id));
 }
 
 
@@ -255,6 +327,7 @@ ms_audio_devices_dispose (GObject *object)
     g_signal_handlers_disconnect_by_data (self->mixer_control, self);
   g_clear_object (&self->mixer_control);
   g_clear_object (&self->devices);
+  g_clear_pointer (&self->info_cache, g_hash_table_destroy);
 
   G_OBJECT_CLASS (ms_audio_devices_parent_class)->dispose (object);
 }
@@ -327,13 +400,25 @@ on_items_changed (MsAudioDevices *self,
   }
 
   g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+
+  if (removed)
+    prune_info_cache (self);
 }
 
 
 static void
 ms_audio_devices_init (MsAudioDevices *self)
 {
-  self->devices = g_list_store_new (MS_TYPE_AUDIO_DEVICE);
+  /* A burst of device changes ends up in a single update */
+  self->devices = ms_indexed_list_store_new (MS_TYPE_AUDIO_DEVICE,
+                                             g_direct_hash,
+                                             g_direct_equal,
+                                             NULL,
+                                             NULL,
+                                             create_device,
+                                             self);
+  self->info_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify) ms_audio_device_info_free);
 
   g_signal_connect_swapped (self->devices, "items-changed", G_CALLBACK (on_items_changed), self);
 }
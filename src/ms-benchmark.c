@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-benchmark"
+
+#include "mobile-settings-config.h"
+
+#include "ms-benchmark.h"
+#include "ms-panel-factory.h"
+#include "ms-trace.h"
+
+#include <json-glib/json-glib.h>
+
+/* Let things settle before measuring the steady state RSS */
+#define SETTLE_TIMEOUT_MS 1000
+#define READY_POLL_INTERVAL_MS 10
+
+/*
+ * Measures startup and the cost of each panel and writes the results
+ * as JSON. Times are in milliseconds, memory in kB:
+ *
+ * - first-frame: From process start until the first frame got painted
+ * - interactive: From process start until the visible panel is ready
+ *   and the main loop got idle
+ * - rss-steady: RSS once startup settled
+ * - rss-peak: Peak RSS at the end of the run
+ * - panels: For each panel the construction time, the time until it
+ *   got painted and the RSS delta caused by showing it
+ */
+
+typedef enum {
+  BENCHMARK_STATE_FIRST_FRAME,
+  BENCHMARK_STATE_INTERACTIVE,
+  BENCHMARK_STATE_PANEL_FRAME,
+  BENCHMARK_STATE_IDLE,
+} BenchmarkState;
+
+typedef struct {
+  char    *name;
+  gboolean deferred;
+  gint64   construct;
+  gint64   frame;
+  gint64   rss_delta;
+} BenchmarkPanel;
+
+typedef struct {
+  MsWindow       *window;
+  char           *filename;
+  BenchmarkState  state;
+
+  gint64          first_frame;
+  gint64          interactive;
+  gint64          rss_steady;
+
+  GArray         *panels;
+  guint           current;
+  gint64          panel_begin;
+  gint64          panel_rss;
+} MsBenchmark;
+
+
+static void
+clear_benchmark_panel (BenchmarkPanel *panel)
+{
+  g_free (panel->name);
+}
+
+
+static void
+ms_benchmark_free (MsBenchmark *self)
+{
+  g_clear_object (&self->window);
+  g_clear_pointer (&self->filename, g_free);
+  g_clear_pointer (&self->panels, g_array_unref);
+  g_free (self);
+}
+
+
+static gint64
+get_status_kb (const char *key)
+{
+  g_autofree char *contents = NULL;
+  g_auto (GStrv) lines = NULL;
+
+  if (!g_file_get_contents ("/proc/self/status", &contents, NULL, NULL))
+    return -1;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (guint i = 0; lines[i]; i++) {
+    if (g_str_has_prefix (lines[i], key))
+      return g_ascii_strtoll (lines[i] + strlen (key), NULL, 10);
+  }
+
+  return -1;
+}
+
+
+static gint64
+since_start (gint64 time)
+{
+  return time - ms_trace_get_process_start ();
+}
+
+
+static void
+write_results (MsBenchmark *self)
+{
+  g_autoptr (JsonBuilder) builder = json_builder_new ();
+  g_autoptr (JsonGenerator) generator = json_generator_new ();
+  g_autoptr (JsonNode) root = NULL;
+  g_autoptr (GError) err = NULL;
+
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "version");
+  json_builder_add_string_value (builder, MOBILE_SETTINGS_VERSION);
+  json_builder_set_member_name (builder, "first-frame");
+  json_builder_add_double_value (builder, since_start (self->first_frame) / 1000.0);
+  json_builder_set_member_name (builder, "interactive");
+  json_builder_add_double_value (builder, since_start (self->interactive) / 1000.0);
+  json_builder_set_member_name (builder, "rss-steady");
+  json_builder_add_int_value (builder, self->rss_steady);
+  json_builder_set_member_name (builder, "rss-peak");
+  json_builder_add_int_value (builder, get_status_kb ("VmHWM:"));
+
+  json_builder_set_member_name (builder, "panels");
+  json_builder_begin_array (builder);
+  for (guint i = 0; i < self->panels->len; i++) {
+    BenchmarkPanel *panel = &g_array_index (self->panels, BenchmarkPanel, i);
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "name");
+    json_builder_add_string_value (builder, panel->name);
+    json_builder_set_member_name (builder, "deferred");
+    json_builder_add_boolean_value (builder, panel->deferred);
+    json_builder_set_member_name (builder, "construct");
+    json_builder_add_double_value (builder, panel->construct / 1000.0);
+    json_builder_set_member_name (builder, "frame");
+    json_builder_add_double_value (builder, panel->frame / 1000.0);
+    json_builder_set_member_name (builder, "rss-delta");
+    json_builder_add_int_value (builder, panel->rss_delta);
+    json_builder_end_object (builder);
+  }
+  json_builder_end_array (builder);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  json_generator_set_root (generator, root);
+  json_generator_set_pretty (generator, TRUE);
+
+  if (!json_generator_to_file (generator, self->filename, &err))
+    g_warning ("Failed to write benchmark results to %s: %s", self->filename, err->message);
+  else
+    g_message ("Benchmark results written to %s", self->filename);
+}
+
+
+static void
+finish (MsBenchmark *self)
+{
+  GtkWidget *window = GTK_WIDGET (self->window);
+
+  g_signal_handlers_disconnect_by_data (gtk_widget_get_frame_clock (window), self);
+
+  write_results (self);
+  ms_benchmark_free (self);
+
+  g_application_quit (g_application_get_default ());
+}
+
+
+static gboolean
+on_next_panel (gpointer user_data)
+{
+  MsBenchmark *self = user_data;
+  MsPanelSwitcher *panel_switcher = ms_window_get_panel_switcher (self->window);
+  BenchmarkPanel *panel;
+  GtkWidget *placeholder;
+  AdwViewStack *stack;
+
+  if (self->current == self->panels->len) {
+    finish (self);
+    return G_SOURCE_REMOVE;
+  }
+
+  panel = &g_array_index (self->panels, BenchmarkPanel, self->current);
+  stack = ms_panel_switcher_get_stack (panel_switcher);
+  placeholder = adw_view_stack_get_child_by_name (stack, panel->name);
+
+  /* Measure building deferred panels from scratch, even if prewarmed */
+  if (panel->deferred)
+    ms_panel_factory_release (panel->name, MS_PANEL (placeholder));
+
+  self->panel_rss = get_status_kb ("VmRSS:");
+  self->panel_begin = g_get_monotonic_time ();
+
+  ms_panel_switcher_set_active_panel_name (panel_switcher, panel->name);
+  /* The panel might have been the visible one already */
+  if (panel->deferred)
+    ms_panel_factory_ensure (panel->name, MS_PANEL (placeholder));
+
+  panel->construct = g_get_monotonic_time () - self->panel_begin;
+
+  self->state = BENCHMARK_STATE_PANEL_FRAME;
+  gtk_widget_queue_draw (GTK_WIDGET (self->window));
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_settled (gpointer user_data)
+{
+  MsBenchmark *self = user_data;
+  GListModel *pages = ms_window_get_stack_pages (self->window);
+
+  self->rss_steady = get_status_kb ("VmRSS:");
+
+  for (guint i = 0; i < g_list_model_get_n_items (pages); i++) {
+    g_autoptr (AdwViewStackPage) page = g_list_model_get_item (pages, i);
+    BenchmarkPanel panel = { 0 };
+
+    panel.name = g_strdup (adw_view_stack_page_get_name (page));
+    panel.deferred = ms_panel_factory_has_panel (panel.name);
+    g_array_append_val (self->panels, panel);
+  }
+
+  self->state = BENCHMARK_STATE_IDLE;
+  g_idle_add (on_next_panel, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_check_interactive (gpointer user_data)
+{
+  MsBenchmark *self = user_data;
+  MsPanelSwitcher *panel_switcher = ms_window_get_panel_switcher (self->window);
+  GtkWidget *visible = adw_view_stack_get_visible_child (ms_panel_switcher_get_stack (panel_switcher));
+
+  if (MS_IS_PANEL (visible) && !ms_panel_get_ready (MS_PANEL (visible)))
+    return G_SOURCE_CONTINUE;
+
+  self->interactive = g_get_monotonic_time ();
+  g_timeout_add (SETTLE_TIMEOUT_MS, on_settled, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_after_paint (GdkFrameClock *frame_clock, MsBenchmark *self)
+{
+  BenchmarkPanel *panel;
+  gint64 now = g_get_monotonic_time ();
+
+  switch (self->state) {
+  case BENCHMARK_STATE_FIRST_FRAME:
+    self->first_frame = now;
+    self->state = BENCHMARK_STATE_INTERACTIVE;
+    g_timeout_add_full (G_PRIORITY_LOW, READY_POLL_INTERVAL_MS, on_check_interactive, self, NULL);
+    break;
+  case BENCHMARK_STATE_PANEL_FRAME:
+    panel = &g_array_index (self->panels, BenchmarkPanel, self->current);
+    panel->frame = now - self->panel_begin;
+    panel->rss_delta = get_status_kb ("VmRSS:") - self->panel_rss;
+    g_debug ("Panel '%s': %.3f ms, %+" G_GINT64_FORMAT " kB",
+             panel->name, panel->frame / 1000.0, panel->rss_delta);
+
+    self->current++;
+    self->state = BENCHMARK_STATE_IDLE;
+    g_idle_add (on_next_panel, self);
+    break;
+  case BENCHMARK_STATE_INTERACTIVE:
+  case BENCHMARK_STATE_IDLE:
+  default:
+    break;
+  }
+}
+
+/**
+ * ms_benchmark_run:
+ * @window: The window to benchmark
+ * @filename: Where to write the results
+ *
+ * Measure startup, then show each panel in turn and write the results
+ * to @filename. Quits the application when done. Call this right after
+ * presenting the window.
+ */
+void
+ms_benchmark_run (MsWindow *window, const char *filename)
+{
+  MsBenchmark *self;
+
+  g_return_if_fail (MS_IS_WINDOW (window));
+  g_return_if_fail (filename);
+  g_return_if_fail (gtk_widget_get_realized (GTK_WIDGET (window)));
+
+  self = g_new0 (MsBenchmark, 1);
+  self->window = g_object_ref (window);
+  self->filename = g_strdup (filename);
+  self->state = BENCHMARK_STATE_FIRST_FRAME;
+  self->panels = g_array_new (FALSE, TRUE, sizeof (BenchmarkPanel));
+  g_array_set_clear_func (self->panels, (GDestroyNotify) clear_benchmark_panel);
+
+  g_signal_connect (gtk_widget_get_frame_clock (GTK_WIDGET (window)),
+                    "after-paint",
+                    G_CALLBACK (on_after_paint),
+                    self);
+}
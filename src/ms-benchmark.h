@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ms-window.h"
+
+G_BEGIN_DECLS
+
+void ms_benchmark_run (MsWindow *window, const char *filename);
+
+G_END_DECLS
@@ -12,6 +12,7 @@
 
 #include "ms-application.h"
 #include "ms-compositor-panel.h"
+#include "ms-indexed-list-store.h"
 #include "ms-scale-to-fit-row.h"
 #include "ms-util.h"
 
@@ -25,35 +26,18 @@ struct _MsCompositorPanel {
   GSettings        *settings;
   GtkWidget        *scale_to_fit_switch;
 
-  GtkListBox        *running_apps_listbox;
-  GListStore        *running_apps_rows;
-  MsToplevelTracker *tracker;
+  GtkListBox         *running_apps_listbox;
+  MsIndexedListStore *running_apps;
+  MsToplevelTracker  *tracker;
 };
 
 G_DEFINE_TYPE (MsCompositorPanel, ms_compositor_panel, MS_TYPE_PANEL)
 
 
-static void
-add_application_row (MsCompositorPanel *self, const char *app_id)
+static gpointer
+create_running_app (gconstpointer app_id, gpointer user_data)
 {
-  MsScaleToFitRow *row;
-
-  row = ms_scale_to_fit_row_new (app_id);
-  g_list_store_append (self->running_apps_rows, row);
-}
-
-
-static void
-remove_application_row (MsCompositorPanel *self, const char *app_id)
-{
-  for (guint pos = 0; pos < g_list_model_get_n_items (G_LIST_MODEL (self->running_apps_rows)); pos++) {
-    MsScaleToFitRow *row = g_list_model_get_item (G_LIST_MODEL (self->running_apps_rows), pos);
-
-    if (g_strcmp0 (ms_scale_to_fit_row_get_app_id (row), app_id) == 0) {
-      g_list_store_remove (self->running_apps_rows, pos);
-      break;
-    }
-  }
+  return gtk_string_object_new (app_id);
 }
 
 
@@ -61,7 +45,7 @@ static void
 on_app_id_added (MsCompositorPanel *self, const char *app_id)
 {
   g_debug ("Adding app-id: %s", app_id);
-  add_application_row (self, app_id);
+  ms_indexed_list_store_add (self->running_apps, app_id);
 }
 
 
@@ -69,39 +53,67 @@ static void
 on_app_id_removed (MsCompositorPanel *self, const char *app_id)
 {
   g_debug ("Removing app-id: %s", app_id);
-  remove_application_row (self, app_id);
+  ms_indexed_list_store_remove (self->running_apps, app_id);
 }
 
 
 static GtkWidget *
 create_scale_to_fit_row (gpointer object, gpointer user_data)
 {
-  return GTK_WIDGET (object);
+  GtkStringObject *app_id = GTK_STRING_OBJECT (object);
+
+  return GTK_WIDGET (ms_scale_to_fit_row_new (gtk_string_object_get_string (app_id)));
+}
+
+static void
+on_running_apps_changed (MsCompositorPanel *self,
+                         GStrv              added,
+                         GStrv              removed,
+                         GStrv              modified)
+{
+  for (guint i = 0; removed[i]; i++)
+    on_app_id_removed (self, removed[i]);
+
+  for (guint i = 0; added[i]; i++)
+    on_app_id_added (self, added[i]);
 }
 
+
 static void
 on_toplevel_tracker_changed (MsCompositorPanel *self, GParamSpec *spec, MsApplication *app)
 {
   MsToplevelTracker *tracker = ms_application_get_toplevel_tracker (app);
-  g_auto (GStrv) app_ids = NULL;
+  GListModel *app_ids;
 
-  if (tracker == NULL)
+  if (self->tracker == tracker)
     return;
 
-  self->tracker = g_object_ref (tracker);
-  g_object_connect (self->tracker,
-                    "swapped_object_signal::app-id-added",
-                    G_CALLBACK (on_app_id_added),
-                    self,
-                    "swapped_object_signal::app-id-removed",
-                    G_CALLBACK (on_app_id_removed),
-                    self,
-                    NULL);
-  app_ids = ms_toplevel_tracker_get_app_ids (self->tracker);
-
-  for (guint i = 0; i < g_strv_length (app_ids); i++) {
-    g_debug ("app-id: %s", app_ids[i]);
-    add_application_row (self, app_ids[i]);
+  if (self->tracker) {
+    g_signal_handlers_disconnect_by_data (self->tracker, self);
+
+    app_ids = G_LIST_MODEL (self->tracker);
+    for (guint i = 0; i < g_list_model_get_n_items (app_ids); i++) {
+      g_autoptr (GtkStringObject) app_id = g_list_model_get_item (app_ids, i);
+
+      on_app_id_removed (self, gtk_string_object_get_string (app_id));
+    }
+  }
+
+  g_set_object (&self->tracker, tracker);
+  if (self->tracker == NULL)
+    return;
+
+  g_signal_connect_object (self->tracker,
+                           "changed",
+                           G_CALLBACK (on_running_apps_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  app_ids = G_LIST_MODEL (self->tracker);
+  for (guint i = 0; i < g_list_model_get_n_items (app_ids); i++) {
+    g_autoptr (GtkStringObject) app_id = g_list_model_get_item (app_ids, i);
+
+    on_app_id_added (self, gtk_string_object_get_string (app_id));
   }
 }
 
@@ -111,7 +123,7 @@ ms_compositor_panel_finalize (GObject *object)
 {
   MsCompositorPanel *self = MS_COMPOSITOR_PANEL (object);
 
-  g_clear_object (&self->running_apps_rows);
+  g_clear_object (&self->running_apps);
   g_clear_object (&self->tracker);
   g_clear_object (&self->settings);
 
@@ -141,9 +153,21 @@ ms_compositor_panel_init (MsCompositorPanel *self)
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
-  self->running_apps_rows = g_list_store_new (MS_TYPE_SCALE_TO_FIT_ROW);
+  /* Changes from one Wayland dispatch end up in a single update */
+  self->running_apps = ms_indexed_list_store_new (GTK_TYPE_STRING_OBJECT,
+                                                  g_str_hash,
+                                                  g_str_equal,
+                                                  (GCopyFunc) g_strdup,
+                                                  g_free,
+                                                  create_running_app,
+                                                  NULL);
+  /*
+   * GtkListBox builds a row for every item up front. There's one row
+   * per running app so that's cheap, the store only makes sure rows
+   * of apps that keep running aren't rebuilt.
+   */
   gtk_list_box_bind_model (self->running_apps_listbox,
-                           G_LIST_MODEL (self->running_apps_rows),
+                           G_LIST_MODEL (self->running_apps),
                            create_scale_to_fit_row,
                            NULL, NULL);
 
@@ -155,9 +179,12 @@ ms_compositor_panel_init (MsCompositorPanel *self)
                    G_SETTINGS_BIND_DEFAULT);
 
   app = MS_APPLICATION (g_application_get_default ());
-  g_signal_connect_swapped (app, "notify::toplevel-tracker",
-                            G_CALLBACK (on_toplevel_tracker_changed), self);
-  on_toplevel_tracker_changed(self, NULL, MS_APPLICATION (g_application_get_default ()));
+  g_signal_connect_object (app,
+                           "notify::toplevel-tracker",
+                           G_CALLBACK (on_toplevel_tracker_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  on_toplevel_tracker_changed (self, NULL, app);
 }
 
 
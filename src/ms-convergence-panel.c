@@ -248,6 +248,20 @@ on_head_removed (MsConvergencePanel *self,
 }
 
 
+static void
+on_heads_changed (MsConvergencePanel *self,
+                  GPtrArray          *added,
+                  GPtrArray          *removed,
+                  GPtrArray          *modified)
+{
+  for (guint i = 0; i < removed->len; i++)
+    on_head_removed (self, g_ptr_array_index (removed, i));
+
+  for (guint i = 0; i < added->len; i++)
+    on_head_added (self, g_ptr_array_index (added, i));
+}
+
+
 static void
 on_head_tracker_changed (MsConvergencePanel *self, GParamSpec *spec, MsApplication *app)
 {
@@ -258,14 +272,11 @@ on_head_tracker_changed (MsConvergencePanel *self, GParamSpec *spec, MsApplicati
     return;
 
   self->tracker = g_object_ref (tracker);
-  g_object_connect (self->tracker,
-                    "swapped_object_signal::head-added",
-                    G_CALLBACK (on_head_added),
-                    self,
-                    "swapped_object_signal::head-removed",
-                    G_CALLBACK (on_head_removed),
-                    self,
-                    NULL);
+  g_signal_connect_object (self->tracker,
+                           "changed",
+                           G_CALLBACK (on_heads_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
 
   heads = ms_head_tracker_get_heads (self->tracker);
   for (guint i = 0; i < heads->len; i++) {
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-feedback-app"
+
+#include "mobile-settings-config.h"
+
+#include "ms-enum-types.h"
+#include "ms-feedback-app.h"
+#include "ms-util.h"
+
+#define G_SETTINGS_ENABLE_BACKEND
+#include <gio/gsettingsbackend.h>
+
+#include <dconf.h>
+
+/* Verbatim from feedbackd */
+#define APP_SCHEMA "org.sigxcpu.feedbackd.application"
+#define APP_PREFIX "/org/sigxcpu/feedbackd/application/"
+#define APP_KEY_PROFILE "profile"
+
+/**
+ * MsFeedbackApp:
+ *
+ * An app's feedback settings. The profile is passed in on construction
+ * (see `ms_feedback_app_read_profiles()`) and the settings object (and
+ * with it the dconf watch) only gets created once the profile is
+ * changed. Constructing an app is thread safe so apps can be loaded off
+ * the main thread.
+ */
+
+enum {
+  PROP_0,
+  PROP_APP_INFO,
+  PROP_SORT_KEY,
+  PROP_PROFILE,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+struct _MsFeedbackApp {
+  GObject            parent;
+
+  GAppInfo          *app_info;
+  char              *munged_app_id;
+  char              *sort_key;
+  MsFeedbackProfile  profile;
+  GSettings         *settings;
+};
+G_DEFINE_TYPE (MsFeedbackApp, ms_feedback_app, G_TYPE_OBJECT)
+
+
+static char *
+get_settings_path (MsFeedbackApp *self)
+{
+  return g_strconcat (APP_PREFIX, self->munged_app_id, "/", NULL);
+}
+
+
+static void
+on_profile_changed (MsFeedbackApp *self)
+{
+  g_autofree char *name = g_settings_get_string (self->settings, APP_KEY_PROFILE);
+  MsFeedbackProfile profile = ms_feedback_profile_from_setting (name);
+
+  if (self->profile == profile)
+    return;
+
+  self->profile = profile;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PROFILE]);
+}
+
+
+static void
+ensure_settings (MsFeedbackApp *self)
+{
+  g_autofree char *path = NULL;
+
+  if (self->settings)
+    return;
+
+  path = get_settings_path (self);
+  g_debug ("Monitoring settings path: %s", path);
+  self->settings = g_settings_new_with_path (APP_SCHEMA, path);
+  g_signal_connect_object (self->settings,
+                           "changed::" APP_KEY_PROFILE,
+                           G_CALLBACK (on_profile_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static void
+ms_feedback_app_set_property (GObject      *object,
+                              guint         property_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  MsFeedbackApp *self = MS_FEEDBACK_APP (object);
+
+  switch (property_id) {
+  case PROP_APP_INFO:
+    self->app_info = g_value_dup_object (value);
+    break;
+  case PROP_PROFILE:
+    ms_feedback_app_set_profile (self, g_value_get_enum (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_feedback_app_get_property (GObject    *object,
+                              guint       property_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  MsFeedbackApp *self = MS_FEEDBACK_APP (object);
+
+  switch (property_id) {
+  case PROP_APP_INFO:
+    g_value_set_object (value, self->app_info);
+    break;
+  case PROP_SORT_KEY:
+    g_value_set_string (value, self->sort_key);
+    break;
+  case PROP_PROFILE:
+    g_value_set_enum (value, self->profile);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_feedback_app_constructed (GObject *object)
+{
+  MsFeedbackApp *self = MS_FEEDBACK_APP (object);
+
+  G_OBJECT_CLASS (ms_feedback_app_parent_class)->constructed (object);
+
+  self->munged_app_id = ms_munge_app_id (g_app_info_get_id (self->app_info));
+  self->sort_key = g_utf8_casefold (g_app_info_get_name (self->app_info), -1);
+}
+
+
+static void
+ms_feedback_app_finalize (GObject *object)
+{
+  MsFeedbackApp *self = MS_FEEDBACK_APP (object);
+
+  g_clear_object (&self->settings);
+  g_clear_object (&self->app_info);
+  g_clear_pointer (&self->munged_app_id, g_free);
+  g_clear_pointer (&self->sort_key, g_free);
+
+  G_OBJECT_CLASS (ms_feedback_app_parent_class)->finalize (object);
+}
+
+
+static void
+ms_feedback_app_class_init (MsFeedbackAppClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = ms_feedback_app_get_property;
+  object_class->set_property = ms_feedback_app_set_property;
+  object_class->constructed = ms_feedback_app_constructed;
+  object_class->finalize = ms_feedback_app_finalize;
+
+  /**
+   * MsFeedbackApp:app-info:
+   *
+   * The app's info. It must have an id and a name.
+   */
+  props[PROP_APP_INFO] =
+    g_param_spec_object ("app-info", "", "",
+                         G_TYPE_APP_INFO,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * MsFeedbackApp:sort-key:
+   *
+   * The casefolded app name for sorting
+   */
+  props[PROP_SORT_KEY] =
+    g_param_spec_string ("sort-key", "", "",
+                         NULL,
+                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  /**
+   * MsFeedbackApp:profile:
+   *
+   * The app's feedback profile
+   */
+  props[PROP_PROFILE] =
+    g_param_spec_enum ("profile", "", "",
+                       MS_TYPE_FEEDBACK_PROFILE,
+                       MS_FEEDBACK_PROFILE_FULL,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+ms_feedback_app_init (MsFeedbackApp *self)
+{
+}
+
+
+/**
+ * ms_feedback_app_new:
+ * @app_info: The app's info
+ * @profile: The app's current feedback profile
+ *
+ * Returns: A new app. The profile isn't written back to the settings.
+ */
+MsFeedbackApp *
+ms_feedback_app_new (GAppInfo *app_info, MsFeedbackProfile profile)
+{
+  MsFeedbackApp *self = g_object_new (MS_TYPE_FEEDBACK_APP, "app-info", app_info, NULL);
+
+  self->profile = profile;
+
+  return self;
+}
+
+
+static gboolean
+is_dconf_backend (void)
+{
+  g_autoptr (GSettingsBackend) backend = g_settings_backend_get_default ();
+
+  return g_str_equal (G_OBJECT_TYPE_NAME (backend), "DConfSettingsBackend");
+}
+
+/* One dconf client for all apps, listing the apps that have settings */
+static void
+read_profiles_dconf (GHashTable *profiles)
+{
+  DConfClient *client = dconf_client_new ();
+  g_auto (GStrv) dirs = NULL;
+
+  dirs = dconf_client_list (client, APP_PREFIX, NULL);
+  for (guint i = 0; dirs[i]; i++) {
+    g_autofree char *key = NULL;
+    g_autoptr (GVariant) value = NULL;
+    gsize len = strlen (dirs[i]);
+
+    if (!g_str_has_suffix (dirs[i], "/"))
+      continue;
+
+    key = g_strconcat (APP_PREFIX, dirs[i], APP_KEY_PROFILE, NULL);
+    value = dconf_client_read (client, key);
+    if (value == NULL || !g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
+      continue;
+
+    dirs[i][len - 1] = '\0';
+    g_hash_table_insert (profiles,
+                         g_strdup (dirs[i]),
+                         GINT_TO_POINTER (ms_feedback_profile_from_setting (g_variant_get_string (value, NULL))));
+  }
+
+  g_object_unref (client);
+}
+
+/* Other backends can't list paths so read each app */
+static void
+read_profiles_gsettings (GHashTable *profiles, const char * const *munged_app_ids)
+{
+  for (guint i = 0; munged_app_ids[i]; i++) {
+    g_autoptr (GSettings) settings = NULL;
+    g_autofree char *path = NULL;
+    g_autofree char *profile = NULL;
+
+    path = g_strconcat (APP_PREFIX, munged_app_ids[i], "/", NULL);
+    settings = g_settings_new_with_path (APP_SCHEMA, path);
+    profile = g_settings_get_string (settings, APP_KEY_PROFILE);
+    g_hash_table_insert (profiles,
+                         g_strdup (munged_app_ids[i]),
+                         GINT_TO_POINTER (ms_feedback_profile_from_setting (profile)));
+  }
+}
+
+/**
+ * ms_feedback_app_read_profiles:
+ * @munged_app_ids: The munged ids of the apps to read the profiles for
+ *
+ * Read the feedback profiles of the given apps. With dconf this is a
+ * single listing of the stored app settings, so no settings objects
+ * (and dconf watches) get created. This is thread safe.
+ *
+ * Returns:(transfer full): The profiles by munged app id
+ */
+GHashTable *
+ms_feedback_app_read_profiles (const char * const *munged_app_ids)
+{
+  g_autoptr (GSettingsSchema) schema = NULL;
+  g_autoptr (GSettingsSchemaKey) key = NULL;
+  g_autoptr (GVariant) default_value = NULL;
+  GHashTable *profiles;
+  MsFeedbackProfile profile;
+
+  g_return_val_if_fail (munged_app_ids, NULL);
+
+  profiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (is_dconf_backend ())
+    read_profiles_dconf (profiles);
+  else
+    read_profiles_gsettings (profiles, munged_app_ids);
+
+  /* Apps without stored settings use the schema's default */
+  schema = g_settings_schema_source_lookup (g_settings_schema_source_get_default (),
+                                            APP_SCHEMA,
+                                            TRUE);
+  key = g_settings_schema_get_key (schema, APP_KEY_PROFILE);
+  default_value = g_settings_schema_key_get_default_value (key);
+  profile = ms_feedback_profile_from_setting (g_variant_get_string (default_value, NULL));
+  for (guint i = 0; munged_app_ids[i]; i++) {
+    if (!g_hash_table_contains (profiles, munged_app_ids[i]))
+      g_hash_table_insert (profiles, g_strdup (munged_app_ids[i]), GINT_TO_POINTER (profile));
+  }
+
+  return profiles;
+}
+
+
+GAppInfo *
+ms_feedback_app_get_app_info (MsFeedbackApp *self)
+{
+  g_return_val_if_fail (MS_IS_FEEDBACK_APP (self), NULL);
+
+  return self->app_info;
+}
+
+
+const char *
+ms_feedback_app_get_munged_app_id (MsFeedbackApp *self)
+{
+  g_return_val_if_fail (MS_IS_FEEDBACK_APP (self), NULL);
+
+  return self->munged_app_id;
+}
+
+
+const char *
+ms_feedback_app_get_sort_key (MsFeedbackApp *self)
+{
+  g_return_val_if_fail (MS_IS_FEEDBACK_APP (self), NULL);
+
+  return self->sort_key;
+}
+
+
+MsFeedbackProfile
+ms_feedback_app_get_profile (MsFeedbackApp *self)
+{
+  g_return_val_if_fail (MS_IS_FEEDBACK_APP (self), MS_FEEDBACK_PROFILE_FULL);
+
+  return self->profile;
+}
+
+/**
+ * ms_feedback_app_set_profile:
+ * @self: The app
+ * @profile: The feedback profile
+ *
+ * Set the app's feedback profile and store it in the app's settings.
+ */
+void
+ms_feedback_app_set_profile (MsFeedbackApp *self, MsFeedbackProfile profile)
+{
+  g_autofree char *name = NULL;
+
+  g_return_if_fail (MS_IS_FEEDBACK_APP (self));
+
+  if (self->profile == profile)
+    return;
+
+  self->profile = profile;
+
+  ensure_settings (self);
+  name = ms_feedback_profile_to_setting (profile);
+  g_settings_set_string (self->settings, APP_KEY_PROFILE, name);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PROFILE]);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ms-enums.h"
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define MS_TYPE_FEEDBACK_APP (ms_feedback_app_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsFeedbackApp, ms_feedback_app, MS, FEEDBACK_APP, GObject)
+
+MsFeedbackApp    *ms_feedback_app_new               (GAppInfo          *app_info,
+                                                     MsFeedbackProfile  profile);
+GHashTable       *ms_feedback_app_read_profiles     (const char * const *munged_app_ids);
+GAppInfo         *ms_feedback_app_get_app_info      (MsFeedbackApp     *self);
+const char       *ms_feedback_app_get_munged_app_id (MsFeedbackApp     *self);
+const char       *ms_feedback_app_get_sort_key      (MsFeedbackApp     *self);
+MsFeedbackProfile ms_feedback_app_get_profile       (MsFeedbackApp     *self);
+void              ms_feedback_app_set_profile       (MsFeedbackApp     *self,
+                                                     MsFeedbackProfile  profile);
+
+G_END_DECLS
@@ -11,11 +11,14 @@
 
 #include "mobile-settings-config.h"
 #include "ms-enums.h"
+#include "ms-app-info-registry.h"
 #include "ms-audio-devices.h"
 #include "ms-audio-device-row.h"
 #include "ms-enum-types.h"
+#include "ms-feedback-app.h"
 #include "ms-feedback-row.h"
 #include "ms-sound-row.h"
+#include "ms-sound-theme-transaction.h"
 #include "ms-feedback-panel.h"
 #include "ms-util.h"
 
@@ -34,8 +37,6 @@
 #define FEEDBACKD_KEY_PROFILE "profile"
 #define FEEDBACKD_KEY_PREFER_FLASH "prefer-flash"
 #define FEEDBACKD_KEY_MAX_HAPTIC_STRENGTH "max-haptic-strength"
-#define APP_SCHEMA FEEDBACKD_SCHEMA_ID ".application"
-#define APP_PREFIX "/org/sigxcpu/feedbackd/application/"
 #define GNOME_SOUND_SCHEMA_ID "org.gnome.desktop.sound"
 #define GNOME_SOUND_KEY_THEME_NAME "theme-name"
 
@@ -45,6 +46,9 @@
 #define NOTIFICATIONS_WAKEUP_SCREEN_URGENCY_KEY "wakeup-screen-urgency"
 #define NOTIFICATIONS_WAKEUP_SCREEN_CATEGORIES_KEY "wakeup-screen-categories"
 
+/* Number of app rows to add per main loop iteration */
+#define APP_BATCH_SIZE 16
+
 enum {
   PROP_0,
   PROP_FEEDBACK_PROFILE,
@@ -74,18 +78,16 @@ static const char * const notification_category_names[] = {
   NULL
 };
 
-typedef struct {
-  char      *munged_app_id;
-  GAppInfo  *app_info;
-  GSettings *settings;
-} MsFbdApplication;
-
 struct _MsFeedbackPanel {
   MsPanel                    parent;
 
   GtkListBox                *app_listbox;
   GtkListBox                *sounds_listbox;
   GHashTable                *known_applications;
+  GListStore                *apps;
+  GCancellable              *load_apps_cancel;
+  GPtrArray                 *pending_apps;
+  guint                      add_apps_id;
   AdwSwitchRow              *quick_silent_switch;
   GtkAdjustment             *haptic_strenth_adj;
   AdwSpinRow                *haptic_strenth_row;
@@ -109,6 +111,9 @@ struct _MsFeedbackPanel {
 
   /* Audio Settings */
   GSettings                 *sound_settings;
+  MsSoundThemeTransaction   *sound_theme;
+  GCancellable              *cache_sounds_cancel;
+  gboolean                   sounds_cached;
   GvcMixerControl           *mixer_control;
   MsAudioDevices            *audio_devices;
   GtkListBox                *audio_devices_listbox;
@@ -158,15 +163,20 @@ display_toast_message (MsFeedbackPanel *self, const char *msg)
 static void
 on_volume_slider_sound_finished (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-  MsFeedbackPanel *self = MS_FEEDBACK_PANEL (user_data);
+  MsFeedbackPanel *self;
   gboolean success;
   g_autoptr (GError) err = NULL;
 
-  g_assert (MS_IS_FEEDBACK_PANEL (self));
-
   success = gsound_context_play_full_finish (GSOUND_CONTEXT (source_object), res, &err);
 
-  if (!success && !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+  /* A newer preview might already be playing or the panel is gone */
+  if (!success && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = MS_FEEDBACK_PANEL (user_data);
+  g_assert (MS_IS_FEEDBACK_PANEL (self));
+
+  if (!success) {
     const char *role = ms_get_media_role_as_string (self->last_volume_slider_role);
     g_autofree char *msg = g_strdup_printf ("Failed to play sound for %s slider", role);
 
@@ -174,7 +184,6 @@ on_volume_slider_sound_finished (GObject *source_object, GAsyncResult *res, gpoi
     display_toast_message (self, msg);
   }
 
-  /* Clear cancellable if unused, if used it's cleared in stop_playback */
   g_clear_object (&self->sound_cancel);
 }
 
@@ -188,6 +197,9 @@ play_volume_slider_sound (gpointer user_data)
 
   g_return_if_fail (GSOUND_IS_CONTEXT (self->sound_context));
 
+  /* Replace any in flight preview rather than stacking them */
+  g_cancellable_cancel (self->sound_cancel);
+  g_clear_object (&self->sound_cancel);
   self->sound_cancel = g_cancellable_new ();
 
   if (self->last_volume_slider_role == MS_MEDIA_ROLE_PHONE) {
@@ -327,12 +339,16 @@ on_sound_play_finished (GObject *source_object, GAsyncResult *res, gpointer user
   const char *msg = NULL;
   MsFeedbackPanel *self;
 
+  success = gsound_context_play_full_finish (GSOUND_CONTEXT (source_object), res, &err);
+
+  /* Cancellable is cleared in stop_playback or the panel is gone */
+  if (!success && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
   self = MS_FEEDBACK_PANEL (user_data);
   g_assert (MS_IS_FEEDBACK_PANEL (self));
 
-  success = gsound_context_play_full_finish (GSOUND_CONTEXT (source_object), res, &err);
-
-  if (!success && !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+  if (!success) {
 
     if (g_error_matches (err, GSOUND_ERROR, GSOUND_ERROR_NOTFOUND)) {
       msg = _("Sound file does not exist");
@@ -348,9 +364,7 @@ on_sound_play_finished (GObject *source_object, GAsyncResult *res, gpointer user
     adw_toast_set_title (self->toast, msg);
   }
 
-  /* Clear cancellable if unused, if used it's cleared in stop_playback */
-  if (success || !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-    g_clear_object (&self->sound_cancel);
+  g_clear_object (&self->sound_cancel);
 }
 
 
@@ -392,18 +406,6 @@ play_sound_activated  (GtkWidget *widget,  const char* action_name, GVariant *pa
 }
 
 
-static void
-app_destroy (gpointer data)
-{
-  MsFbdApplication *app = data;
-
-  g_clear_object (&app->settings);
-  g_clear_object (&app->app_info);
-  g_clear_pointer (&app->munged_app_id, g_free);
-  g_slice_free (MsFbdApplication, app);
-}
-
-
 static char *
 item_feedback_profile_name (AdwEnumListItem   *item,
                             gpointer user_data G_GNUC_UNUSED)
@@ -438,20 +440,17 @@ settings_profile_to_name (const GValue       *value,
 }
 
 
-static void
-add_application_row (MsFeedbackPanel *self, MsFbdApplication *app)
+static GtkWidget *
+create_app_row (gpointer item, gpointer user_data)
 {
+  MsFeedbackApp *app = MS_FEEDBACK_APP (item);
+  GAppInfo *app_info = ms_feedback_app_get_app_info (app);
   GtkWidget *w;
   MsFeedbackRow *row;
   g_autoptr (GIcon) icon = NULL;
   g_autofree char *markup = NULL;
-  const char *app_name;
 
-  app_name = g_app_info_get_name (app->app_info);
-  if (GM_STR_IS_NULL_OR_EMPTY (app_name))
-    return;
-
-  icon = g_app_info_get_icon (app->app_info);
+  icon = g_app_info_get_icon (app_info);
   if (icon == NULL)
     icon = g_themed_icon_new ("application-x-executable");
   else
@@ -460,112 +459,228 @@ add_application_row (MsFeedbackPanel *self, MsFbdApplication *app)
   row = ms_feedback_row_new ();
 
   /* TODO: we can move most of this into MsMobileSettingsRow */
-  markup = g_markup_escape_text (app_name, -1);
+  markup = g_markup_escape_text (g_app_info_get_name (app_info), -1);
   adw_preferences_row_set_title (ADW_PREFERENCES_ROW (row), markup);
-  g_object_set_data_full (G_OBJECT (row), "app", app, app_destroy);
-  g_settings_bind_with_mapping (app->settings, FEEDBACKD_KEY_PROFILE,
-                                row, "feedback-profile",
-                                G_SETTINGS_BIND_DEFAULT,
-                                settings_name_to_profile,
-                                settings_profile_to_name,
-                                NULL, NULL);
-
-  gtk_list_box_append (self->app_listbox, GTK_WIDGET (row));
+  g_object_bind_property (app, "profile",
+                          row, "feedback-profile",
+                          G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
 
   w = gtk_image_new_from_gicon (icon);
   gtk_widget_add_css_class (w, "lowres-icon");
   gtk_image_set_icon_size (GTK_IMAGE (w), GTK_ICON_SIZE_LARGE);
   adw_action_row_add_prefix (ADW_ACTION_ROW (row), w);
 
-  g_hash_table_add (self->known_applications, g_strdup (app->munged_app_id));
+  return GTK_WIDGET (row);
+}
+
+
+static gboolean
+has_category (const char *categories, const char *category)
+{
+  gsize len = strlen (category);
+
+  for (const char *c = strstr (categories, category); c; c = strstr (c + 1, category)) {
+    if ((c == categories || c[-1] == ';') && (c[len] == ';' || c[len] == '\0'))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static gboolean
+app_is_system_service (GDesktopAppInfo *app)
+{
+  const gchar *categories;
+
+  categories = g_desktop_app_info_get_categories (app);
+  if (gm_str_is_null_or_empty (categories))
+    return FALSE;
+
+  return has_category (categories, "X-GNOME-Settings-Panel") ||
+    has_category (categories, "Settings") ||
+    has_category (categories, "System");
 }
 
 
-static int
-app_listbox_sort (GtkListBoxRow *row1, GtkListBoxRow *row2, gpointer user_data)
+static gboolean
+app_uses_feedback (GDesktopAppInfo *app)
 {
-  const char *title1 = adw_preferences_row_get_title (ADW_PREFERENCES_ROW (row1));
-  const char *title2 = adw_preferences_row_get_title (ADW_PREFERENCES_ROW (row2));
-  g_autofree char* lower1 = g_utf8_casefold (title1, -1);
-  g_autofree char* lower2 = g_utf8_casefold (title2, -1);
+  if (g_desktop_app_info_get_boolean (app, "X-Phosh-UsesFeedback")) {
+    g_debug ("App '%s' uses libfeedback", g_app_info_get_id (G_APP_INFO (app)));
+    return TRUE;
+  }
 
-  return strcmp (lower1, lower2);
+  if (g_desktop_app_info_get_boolean (app, "X-GNOME-UsesNotifications")) {
+    g_debug ("App '%s' uses notifications", g_app_info_get_id (G_APP_INFO (app)));
+    return !app_is_system_service (app);
+  }
+
+  return FALSE;
 }
 
 
 static void
-process_app_info (MsFeedbackPanel *self, GAppInfo *app_info)
+load_apps_in_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
 {
-  MsFbdApplication *app;
-  const char *app_id;
-  g_autofree char *munged_id = NULL;
-  g_autofree char *path = NULL;
+  GPtrArray *all_apps = task_data;
+  GPtrArray *apps = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr (GPtrArray) app_infos = g_ptr_array_new ();
+  g_autoptr (GPtrArray) munged_ids = g_ptr_array_new_with_free_func (g_free);
+  g_autoptr (GHashTable) seen = g_hash_table_new (g_str_hash, g_str_equal);
+  g_autoptr (GHashTable) profiles = NULL;
+
+  for (guint i = 0; i < all_apps->len; i++) {
+    GAppInfo *app_info = g_ptr_array_index (all_apps, i);
+    char *munged_id;
+
+    if (g_cancellable_is_cancelled (cancellable))
+      break;
 
-  app_id = g_app_info_get_id (app_info);
-  if (GM_STR_IS_NULL_OR_EMPTY (app_id))
-    return;
+    if (GM_STR_IS_NULL_OR_EMPTY (g_app_info_get_id (app_info)) ||
+        GM_STR_IS_NULL_OR_EMPTY (g_app_info_get_name (app_info)))
+      continue;
 
-  munged_id = ms_munge_app_id (app_id);
+    if (!app_uses_feedback (G_DESKTOP_APP_INFO (app_info)))
+      continue;
 
-  app = g_slice_new (MsFbdApplication);
+    munged_id = ms_munge_app_id (g_app_info_get_id (app_info));
+    if (!g_hash_table_add (seen, munged_id)) {
+      g_free (munged_id);
+      continue;
+    }
 
-  path = g_strconcat (APP_PREFIX, munged_id, "/", NULL);
-  g_debug ("Monitoring settings path: %s", path);
-  app->settings = g_settings_new_with_path (APP_SCHEMA, path);
-  app->app_info = g_object_ref (app_info);
-  app->munged_app_id = g_steal_pointer (&munged_id);
+    g_ptr_array_add (app_infos, app_info);
+    g_ptr_array_add (munged_ids, munged_id);
+  }
+  g_ptr_array_add (munged_ids, NULL);
 
-  if (g_hash_table_contains (self->known_applications, app->munged_app_id))
-    return;
+  /* Read all profiles in one go rather than per app */
+  profiles = ms_feedback_app_read_profiles ((const char * const *) munged_ids->pdata);
+  for (guint i = 0; i < app_infos->len; i++) {
+    MsFeedbackProfile profile;
 
-  g_debug ("Processing queued application %s", app->munged_app_id);
+    profile = GPOINTER_TO_INT (g_hash_table_lookup (profiles, g_ptr_array_index (munged_ids, i)));
+    g_ptr_array_add (apps, ms_feedback_app_new (g_ptr_array_index (app_infos, i), profile));
+  }
 
-  add_application_row (self, app);
+  g_task_return_pointer (task, apps, (GDestroyNotify) g_ptr_array_unref);
 }
 
 
 static gboolean
-app_is_system_service (GDesktopAppInfo *app)
+on_add_apps_batch (gpointer user_data)
 {
-  g_auto (GStrv) split = NULL;
-  const gchar *categories;
+  MsFeedbackPanel *self = MS_FEEDBACK_PANEL (user_data);
+  guint n = MIN (APP_BATCH_SIZE, self->pending_apps->len);
 
-  categories = g_desktop_app_info_get_categories (app);
-  if (gm_str_is_null_or_empty (categories))
-    return FALSE;
+  for (guint i = 0; i < n; i++) {
+    MsFeedbackApp *app = g_ptr_array_index (self->pending_apps, i);
 
-  split = g_strsplit (categories, ";", -1);
-  if (g_strv_contains ((const gchar* const*) split, "X-GNOME-Settings-Panel") ||
-      g_strv_contains ((const gchar* const*) split, "Settings") ||
-      g_strv_contains ((const gchar* const*) split, "System")) {
-    return TRUE;
+    g_debug ("Adding application %s", ms_feedback_app_get_munged_app_id (app));
+    g_hash_table_insert (self->known_applications,
+                         g_strdup (ms_feedback_app_get_munged_app_id (app)),
+                         app);
   }
-
-  return FALSE;
+  g_list_store_splice (self->apps,
+                       g_list_model_get_n_items (G_LIST_MODEL (self->apps)),
+                       0,
+                       self->pending_apps->pdata,
+                       n);
+  g_ptr_array_remove_range (self->pending_apps, 0, n);
+
+  if (self->pending_apps->len)
+    return G_SOURCE_CONTINUE;
+
+  self->add_apps_id = 0;
+  return G_SOURCE_REMOVE;
 }
 
 
 static void
-load_apps (MsFeedbackPanel *self)
+on_apps_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-  GList *iter, *apps;
+  MsFeedbackPanel *self;
+  g_autoptr (GPtrArray) apps = NULL;
+  g_autoptr (GHashTable) current = NULL;
+  g_autoptr (GError) err = NULL;
+  GHashTableIter iter;
+  const char *munged_id;
+  MsFeedbackApp *app;
+
+  apps = g_task_propagate_pointer (G_TASK (res), &err);
+  if (apps == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to load apps: %s", err->message);
+    return;
+  }
 
-  apps = g_app_info_get_all ();
+  self = MS_FEEDBACK_PANEL (user_data);
+  current = g_hash_table_new (g_str_hash, g_str_equal);
+  g_ptr_array_set_size (self->pending_apps, 0);
 
-  for (iter = apps; iter; iter = iter->next) {
-    GDesktopAppInfo *app;
+  /* Only queue apps we don't know about yet */
+  for (guint i = 0; i < apps->len;) {
+    MsFeedbackApp *app = g_ptr_array_index (apps, i);
+    const char *id = ms_feedback_app_get_munged_app_id (app);
 
-    app = G_DESKTOP_APP_INFO (iter->data);
-    if (g_desktop_app_info_get_boolean (app, "X-Phosh-UsesFeedback")) {
-      g_debug ("App '%s' uses libfeedback", g_app_info_get_id (G_APP_INFO (app)));
-      process_app_info (self, G_APP_INFO (app));
-    } else if (g_desktop_app_info_get_boolean (app, "X-GNOME-UsesNotifications")) {
-      g_debug ("App '%s' uses notifications", g_app_info_get_id (G_APP_INFO (app)));
-      if (!app_is_system_service (app))
-        process_app_info (self, G_APP_INFO (app));
+    g_hash_table_add (current, (gpointer) id);
+    if (g_hash_table_contains (self->known_applications, id)) {
+      i++;
+      continue;
     }
+
+    g_ptr_array_add (self->pending_apps, g_ptr_array_steal_index_fast (apps, i));
   }
-  g_list_free_full (apps, g_object_unref);
+
+  /* Drop the rows of apps that went away */
+  g_hash_table_iter_init (&iter, self->known_applications);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &munged_id, (gpointer *) &app)) {
+    guint pos;
+
+    if (g_hash_table_contains (current, munged_id))
+      continue;
+
+    g_debug ("App %s went away", munged_id);
+    if (g_list_store_find (self->apps, app, &pos))
+      g_list_store_remove (self->apps, pos);
+    g_hash_table_iter_remove (&iter);
+  }
+
+  g_debug ("%u apps to add", self->pending_apps->len);
+  if (self->pending_apps->len && self->add_apps_id == 0) {
+    self->add_apps_id = g_idle_add (on_add_apps_batch, self);
+    g_source_set_name_by_id (self->add_apps_id, "[ms] add feedback apps");
+  }
+}
+
+/*
+ * Filtering the apps and reading their settings is slow so it happens
+ * in a thread. Rows are only added or removed for apps that changed.
+ */
+static void
+load_apps (MsFeedbackPanel *self)
+{
+  MsAppInfoRegistry *registry = ms_app_info_registry_get_default ();
+  g_autoptr (GTask) task = NULL;
+
+  /* Wait for the registry to enumerate the installed apps */
+  if (!ms_app_info_registry_get_loaded (registry))
+    return;
+
+  g_cancellable_cancel (self->load_apps_cancel);
+  g_clear_object (&self->load_apps_cancel);
+  self->load_apps_cancel = g_cancellable_new ();
+
+  task = g_task_new (NULL, self->load_apps_cancel, on_apps_loaded, self);
+  g_task_set_source_tag (task, load_apps);
+  g_task_set_task_data (task,
+                        ms_app_info_registry_dup_all (registry),
+                        (GDestroyNotify) g_ptr_array_unref);
+  g_task_run_in_thread (task, load_apps_in_thread);
 }
 
 
@@ -669,6 +784,89 @@ on_notifications_settings_changed (MsFeedbackPanel *self)
 }
 
 
+static void
+on_sounds_cached (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (res), &err)) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to cache event sounds: %s", err->message);
+    return;
+  }
+
+  g_debug ("Event sounds cached");
+}
+
+
+static void
+cache_sounds_in_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  GSoundContext *sound_context = GSOUND_CONTEXT (source_object);
+  GStrv event_ids = task_data;
+
+  for (guint i = 0; event_ids[i]; i++) {
+    g_autoptr (GError) err = NULL;
+
+    if (g_task_return_error_if_cancelled (task))
+      return;
+
+    if (!gsound_context_cache (sound_context, &err,
+                               GSOUND_ATTR_EVENT_ID, event_ids[i],
+                               NULL)) {
+      g_debug ("Failed to cache sound for '%s': %s", event_ids[i], err->message);
+    }
+  }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/*
+ * Upload the sounds the volume sliders play by event id to the sound
+ * server so their previews don't need a theme lookup and decode. The
+ * sound rows play their files directly so caching doesn't help them.
+ * Decoding is slow so it happens in a thread.
+ */
+static void
+cache_sounds (MsFeedbackPanel *self)
+{
+  static const MsMediaRole roles[] = {
+    MS_MEDIA_ROLE_ALARM,
+    MS_MEDIA_ROLE_ALERT,
+    MS_MEDIA_ROLE_MULTIMEDIA,
+    MS_MEDIA_ROLE_NOTIFICATION,
+    MS_MEDIA_ROLE_RINGTONE,
+  };
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_autoptr (GHashTable) seen = g_hash_table_new (g_str_hash, g_str_equal);
+  g_autoptr (GTask) task = NULL;
+
+  if (self->sounds_cached || self->sound_context == NULL)
+    return;
+
+  self->sounds_cached = TRUE;
+
+  for (guint i = 0; i < G_N_ELEMENTS (roles); i++) {
+    const char *event_id = ms_get_event_id_for_media_role (roles[i]);
+
+    if (g_hash_table_add (seen, (gpointer) event_id))
+      g_strv_builder_add (builder, event_id);
+  }
+
+  g_cancellable_cancel (self->cache_sounds_cancel);
+  g_clear_object (&self->cache_sounds_cancel);
+  self->cache_sounds_cancel = g_cancellable_new ();
+
+  task = g_task_new (self->sound_context, self->cache_sounds_cancel, on_sounds_cached, NULL);
+  g_task_set_source_tag (task, cache_sounds);
+  g_task_set_task_data (task, g_strv_builder_end (builder), (GDestroyNotify) g_strfreev);
+  g_task_run_in_thread (task, cache_sounds_in_thread);
+}
+
+
 static void
 on_sound_theme_name_changed (MsFeedbackPanel *self, const char *key, GSettings *settings)
 {
@@ -685,6 +883,11 @@ on_sound_theme_name_changed (MsFeedbackPanel *self, const char *key, GSettings *
 
   if (!ok)
     g_warning ("Failed to set sound theme name to %s: %s", key, error->message);
+
+  /* The cached sounds are from the old theme */
+  self->sounds_cached = FALSE;
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    cache_sounds (self);
 }
 
 
@@ -871,6 +1074,11 @@ ms_feedback_panel_constructed (GObject *object)
 
   G_OBJECT_CLASS (ms_feedback_panel_parent_class)->constructed (object);
 
+  g_signal_connect_object (ms_app_info_registry_get_default (),
+                           "changed",
+                           G_CALLBACK (load_apps),
+                           self,
+                           G_CONNECT_SWAPPED);
   load_apps (self);
 
   self->settings = g_settings_new (FEEDBACKD_SCHEMA_ID);
@@ -917,6 +1125,13 @@ ms_feedback_panel_dispose (GObject *object)
   g_cancellable_cancel (self->check_alarm_app_cancel);
   g_clear_object (&self->check_alarm_app_cancel);
 
+  g_cancellable_cancel (self->load_apps_cancel);
+  g_clear_object (&self->load_apps_cancel);
+  g_clear_handle_id (&self->add_apps_id, g_source_remove);
+  g_clear_pointer (&self->pending_apps, g_ptr_array_unref);
+
+  g_clear_handle_id (&self->update_id, g_source_remove);
+  g_cancellable_cancel (self->sound_cancel);
   g_clear_object (&self->sound_cancel);
   g_clear_object (&self->sound_context);
 
@@ -924,7 +1139,11 @@ ms_feedback_panel_dispose (GObject *object)
   g_clear_object (&self->notifications_settings);
   g_strfreev (self->notifications_wakeup_categories);
   g_clear_pointer (&self->known_applications, g_hash_table_unref);
+  g_clear_object (&self->apps);
   g_clear_object (&self->sound_settings);
+  g_clear_object (&self->sound_theme);
+  g_cancellable_cancel (self->cache_sounds_cancel);
+  g_clear_object (&self->cache_sounds_cancel);
   g_clear_object (&self->media_role_phone_stream);
 
   g_clear_object (&self->audio_devices);
@@ -934,6 +1153,28 @@ ms_feedback_panel_dispose (GObject *object)
 }
 
 
+static void
+ms_feedback_panel_map (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (ms_feedback_panel_parent_class)->map (widget);
+
+  cache_sounds (MS_FEEDBACK_PANEL (widget));
+}
+
+
+static void
+ms_feedback_panel_unmap (GtkWidget *widget)
+{
+  MsFeedbackPanel *self = MS_FEEDBACK_PANEL (widget);
+
+  /* Don't leave changes pending while the panel isn't shown */
+  if (self->sound_theme)
+    ms_sound_theme_transaction_commit (self->sound_theme);
+
+  GTK_WIDGET_CLASS (ms_feedback_panel_parent_class)->unmap (widget);
+}
+
+
 static void
 ms_feedback_panel_class_init (MsFeedbackPanelClass *klass)
 {
@@ -945,6 +1186,9 @@ ms_feedback_panel_class_init (MsFeedbackPanelClass *klass)
   object_class->constructed = ms_feedback_panel_constructed;
   object_class->dispose = ms_feedback_panel_dispose;
 
+  widget_class->map = ms_feedback_panel_map;
+  widget_class->unmap = ms_feedback_panel_unmap;
+
   props[PROP_FEEDBACK_PROFILE] =
     g_param_spec_enum ("feedback-profile", "", "",
                        MS_TYPE_FEEDBACK_PROFILE,
@@ -995,6 +1239,7 @@ ms_feedback_panel_init_audio (MsFeedbackPanel *self)
 {
   const char *resource_path = "/mobi/phosh/MobileSettings/voice-call.ogg";
 
+  self->sound_theme = ms_sound_theme_transaction_new ();
   self->sound_settings = g_settings_new (GNOME_SOUND_SCHEMA_ID);
 
   g_signal_connect_object (self->sound_settings,
@@ -1020,8 +1265,6 @@ ms_feedback_panel_init_audio (MsFeedbackPanel *self)
                           self->sound_settings_group,
                           "visible",
                           G_BINDING_DEFAULT | G_BINDING_SYNC_CREATE);
-
-  gtk_list_box_set_sort_func (self->app_listbox, app_listbox_sort, NULL, NULL);
 }
 
 
@@ -1086,6 +1329,9 @@ static void
 ms_feedback_panel_init (MsFeedbackPanel *self)
 {
   g_autoptr (GError) error = NULL;
+  g_autoptr (GtkSortListModel) sorted_apps = NULL;
+  GtkExpression *expression;
+  GtkStringSorter *sorter;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
@@ -1115,7 +1361,21 @@ ms_feedback_panel_init (MsFeedbackPanel *self)
   update_category_switches_sensitivity (self);
 
   self->known_applications = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                    NULL, g_free);
+                                                    g_free, NULL);
+  self->pending_apps = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* Sort keys are casefolded already and computed once per app */
+  expression = gtk_property_expression_new (MS_TYPE_FEEDBACK_APP, NULL, "sort-key");
+  sorter = gtk_string_sorter_new (expression);
+  gtk_string_sorter_set_ignore_case (sorter, FALSE);
+  self->apps = g_list_store_new (MS_TYPE_FEEDBACK_APP);
+  /* gtk_sort_list_model takes ownership */
+  sorted_apps = gtk_sort_list_model_new (G_LIST_MODEL (g_object_ref (self->apps)), GTK_SORTER (sorter));
+  gtk_list_box_bind_model (self->app_listbox,
+                           G_LIST_MODEL (sorted_apps),
+                           create_app_row,
+                           self,
+                           NULL);
 
   self->sound_context = gsound_context_new (NULL, &error);
   if (self->sound_context == NULL)
@@ -1131,3 +1391,19 @@ ms_feedback_panel_new (void)
 {
   return MS_FEEDBACK_PANEL (g_object_new (MS_TYPE_FEEDBACK_PANEL, NULL));
 }
+
+/**
+ * ms_feedback_panel_get_sound_theme:
+ * @self: The feedback panel
+ *
+ * Get the transaction used to batch changes to the custom sound theme.
+ *
+ * Returns:(transfer none): The sound theme transaction
+ */
+MsSoundThemeTransaction *
+ms_feedback_panel_get_sound_theme (MsFeedbackPanel *self)
+{
+  g_return_val_if_fail (MS_IS_FEEDBACK_PANEL (self), NULL);
+
+  return self->sound_theme;
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "ms-panel.h"
+#include "ms-sound-theme-transaction.h"
 #include <gsound.h>
 
 
@@ -18,5 +19,6 @@ G_DECLARE_FINAL_TYPE (MsFeedbackPanel, ms_feedback_panel, MS, FEEDBACK_PANEL, Ms
 
 MsFeedbackPanel *ms_feedback_panel_new (void);
 void             ms_feedback_panel_play_sound_file (MsFeedbackPanel *self, const char *file);
+MsSoundThemeTransaction *ms_feedback_panel_get_sound_theme (MsFeedbackPanel *self);
 
 G_END_DECLS
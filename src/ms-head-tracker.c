@@ -14,6 +14,16 @@
 
 #include "wlr-output-management-unstable-v1-client-protocol.h"
 
+/**
+ * MsHeadTracker:
+ *
+ * Tracks the outputs (heads) announced by the compositor. The heads are
+ * exposed as a list model. Changes are collected until the output
+ * manager's `done` event and then applied at once so a hot plug results
+ * in a single `items-changed` and a single [signal@HeadTracker::changed]
+ * emission.
+ */
+
 enum {
   PROP_0,
   PROP_OUTPUT_MANAGER,
@@ -23,8 +33,7 @@ static GParamSpec *props[PROP_LAST_PROP];
 
 
 enum {
-  HEAD_ADDED,
-  HEAD_REMOVED,
+  CHANGED,
   N_SIGNALS
 };
 static guint signals[N_SIGNALS];
@@ -34,14 +43,47 @@ struct _MsHeadTracker {
   GObject               parent;
 
   GPtrArray            *heads;
+  /* Pending changes, applied on `done` */
   GPtrArray            *heads_added;
+  GPtrArray            *heads_removed;
+  GPtrArray            *heads_modified;
 
   struct zwlr_output_manager_v1 *output_manager;
 };
 
-G_DEFINE_TYPE (MsHeadTracker, ms_head_tracker, G_TYPE_OBJECT)
+static void ms_list_model_iface_init (GListModelInterface *iface);
+G_DEFINE_TYPE_WITH_CODE (MsHeadTracker, ms_head_tracker, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, ms_list_model_iface_init))
 
-G_DEFINE_BOXED_TYPE (MsHead, ms_head, ms_head_ref, ms_head_unref);
+G_DEFINE_TYPE (MsHead, ms_head, G_TYPE_OBJECT)
+
+
+static void
+head_modified (MsHead *head)
+{
+  MsHeadTracker *self = head->tracker;
+
+  /* Heads not announced yet get reported as added */
+  if (!g_ptr_array_find (self->heads, head, NULL))
+    return;
+
+  if (g_ptr_array_find (self->heads_modified, head, NULL))
+    return;
+
+  g_ptr_array_add (self->heads_modified, g_object_ref (head));
+}
+
+
+static void
+head_set_string (MsHead *head, char **field, const char *value)
+{
+  if (g_strcmp0 (*field, value) == 0)
+    return;
+
+  g_free (*field);
+  *field = g_strdup (value);
+  head_modified (head);
+}
 
 
 static void
@@ -52,8 +94,12 @@ zwlr_output_mode_v1_handle_size (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->width == width && head->height == height)
+    return;
+
   head->width = width;
   head->height = height;
+  head_modified (head);
 }
 
 
@@ -64,7 +110,11 @@ zwlr_output_mode_v1_handle_refresh (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->refresh_rate == refresh)
+    return;
+
   head->refresh_rate = refresh;
+  head_modified (head);
 }
 
 
@@ -99,8 +149,7 @@ handle_zwlr_output_head_name (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->name);
-  head->name = g_strdup (name);
+  head_set_string (head, &head->name, name);
 
   g_debug ("%p: Got name %s", zwlr_output_head_v1, name);
 }
@@ -113,8 +162,7 @@ handle_zwlr_output_head_description (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->description);
-  head->description = g_strdup (description);
+  head_set_string (head, &head->description, description);
 }
 
 
@@ -126,8 +174,12 @@ handle_zwlr_output_head_physical_size (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->physical_width == width && head->physical_height == height)
+    return;
+
   head->physical_width = width;
   head->physical_height = height;
+  head_modified (head);
 }
 
 
@@ -147,7 +199,11 @@ handle_zwlr_output_head_enabled (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->enabled == !!enabled)
+    return;
+
   head->enabled = !!enabled;
+  head_modified (head);
 }
 
 
@@ -158,8 +214,12 @@ handle_zwlr_output_head_current_mode (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->current_mode);
+  /* The mode is owned by the mode listener */
+  if (head->current_mode == mode)
+    return;
+
   head->current_mode = mode;
+  head_modified (head);
 }
 
 
@@ -171,8 +231,12 @@ handle_zwlr_output_head_position (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->x == x && head->y == y)
+    return;
+
   head->x = x;
   head->y = y;
+  head_modified (head);
 }
 
 
@@ -183,7 +247,11 @@ handle_zwlr_output_head_transform (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->transform == transform)
+    return;
+
   head->transform = transform;
+  head_modified (head);
 }
 
 
@@ -194,7 +262,11 @@ handle_zwlr_output_head_scale (void                       *data,
 {
   MsHead *head = data;
 
+  if (head->scale == scale)
+    return;
+
   head->scale = scale;
+  head_modified (head);
 }
 
 
@@ -203,16 +275,19 @@ handle_zwlr_output_head_finished (void                       *data,
                                   struct zwlr_output_head_v1 *zwlr_output_head_v1)
 {
   MsHead *head = data;
-  guint index;
+  MsHeadTracker *self = head->tracker;
 
-  if (g_ptr_array_find (head->tracker->heads, head, &index) == FALSE) {
+  /* Never announced, so nothing to report */
+  if (g_ptr_array_remove (self->heads_added, head))
+    return;
+
+  if (g_ptr_array_find (self->heads, head, NULL) == FALSE) {
     g_warning ("Trying to remove inexistent head %p", head);
     return;
   }
 
-  g_signal_emit (head->tracker, signals[HEAD_REMOVED], 0, head);
-
-  g_ptr_array_remove_index_fast (head->tracker->heads, index);
+  g_ptr_array_remove (self->heads_modified, head);
+  g_ptr_array_add (self->heads_removed, g_object_ref (head));
 }
 
 
@@ -223,8 +298,7 @@ handle_zwlr_output_head_make (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->make);
-  head->make = g_strdup (make);
+  head_set_string (head, &head->make, make);
 
   g_debug ("%p: Got make %s", zwlr_output_head_v1, make);
 }
@@ -237,8 +311,7 @@ handle_zwlr_output_head_model (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->model);
-  head->model = g_strdup (model);
+  head_set_string (head, &head->model, model);
 
   g_debug ("%p: Got model %s", zwlr_output_head_v1, model);
 }
@@ -251,8 +324,7 @@ handle_zwlr_output_head_serial_number (void                       *data,
 {
   MsHead *head = data;
 
-  g_free (head->serial_number);
-  head->serial_number = g_strdup (serial_number);
+  head_set_string (head, &head->serial_number, serial_number);
 
   g_debug ("%p: Got serial number %s", zwlr_output_head_v1, serial_number);
 }
@@ -276,25 +348,42 @@ static const struct zwlr_output_head_v1_listener zwlr_output_head_v1_listener =
 
 
 static void
-ms_head_destroy (gpointer data)
+ms_head_finalize (GObject *object)
 {
-  MsHead *head = data;
+  MsHead *head = MS_HEAD (object);
 
   g_debug ("Destroying head %s", head->name);
   g_clear_pointer (&head->name, g_free);
   g_clear_pointer (&head->make, g_free);
   g_clear_pointer (&head->model, g_free);
+  g_clear_pointer (&head->description, g_free);
   g_clear_pointer (&head->serial_number, g_free);
   g_clear_pointer (&head->head, zwlr_output_head_v1_destroy);
+
+  G_OBJECT_CLASS (ms_head_parent_class)->finalize (object);
+}
+
+
+static void
+ms_head_class_init (MsHeadClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = ms_head_finalize;
+}
+
+
+static void
+ms_head_init (MsHead *self)
+{
 }
 
 
 static MsHead *
 ms_head_new (struct zwlr_output_head_v1 *zwlr_output_head_v1, MsHeadTracker *tracker)
 {
-  MsHead *head = g_new0 (MsHead, 1);
+  MsHead *head = g_object_new (MS_TYPE_HEAD, NULL);
 
-  g_atomic_ref_count_init (&head->ref_count);
   head->head = zwlr_output_head_v1;
   head->tracker = tracker;
 
@@ -325,13 +414,43 @@ handle_zwlr_output_manager_done (void                          *data,
                                  uint32_t                       serial)
 {
   MsHeadTracker *self = MS_HEAD_TRACKER (data);
+  g_autoptr (GPtrArray) added = NULL;
+  g_autoptr (GPtrArray) removed = NULL;
+  g_autoptr (GPtrArray) modified = NULL;
+  guint n_items, first;
+
+  added = g_steal_pointer (&self->heads_added);
+  removed = g_steal_pointer (&self->heads_removed);
+  modified = g_steal_pointer (&self->heads_modified);
+  self->heads_added = g_ptr_array_new_with_free_func (g_object_unref);
+  self->heads_removed = g_ptr_array_new_with_free_func (g_object_unref);
+  self->heads_modified = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (added->len == 0 && removed->len == 0 && modified->len == 0)
+    return;
 
-  while (self->heads_added->len) {
-    MsHead *head = g_ptr_array_steal_index_fast (self->heads_added, 0);
+  /* Everything from the first removed head on changes position */
+  n_items = self->heads->len;
+  first = n_items;
+  for (guint i = 0; i < removed->len; i++) {
+    guint index;
 
-    g_ptr_array_add (self->heads, head);
-    g_signal_emit (head->tracker, signals[HEAD_ADDED], 0, head);
+    if (g_ptr_array_find (self->heads, g_ptr_array_index (removed, i), &index))
+      first = MIN (first, index);
   }
+
+  for (guint i = 0; i < removed->len; i++)
+    g_ptr_array_remove (self->heads, g_ptr_array_index (removed, i));
+
+  for (guint i = 0; i < added->len; i++)
+    g_ptr_array_add (self->heads, g_object_ref (g_ptr_array_index (added, i)));
+
+  g_debug ("Heads: %u added, %u removed, %u modified", added->len, removed->len, modified->len);
+
+  if (first < n_items || added->len)
+    g_list_model_items_changed (G_LIST_MODEL (self), first, n_items - first, self->heads->len - first);
+
+  g_signal_emit (self, signals[CHANGED], 0, added, removed, modified);
 }
 
 
@@ -350,6 +469,43 @@ static const struct zwlr_output_manager_v1_listener zwlr_output_manager_listener
 };
 
 
+static GType
+ms_list_model_get_item_type (GListModel *list)
+{
+  return MS_TYPE_HEAD;
+}
+
+
+static gpointer
+ms_list_model_get_item (GListModel *list, guint position)
+{
+  MsHeadTracker *self = MS_HEAD_TRACKER (list);
+
+  if (position >= self->heads->len)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (self->heads, position));
+}
+
+
+static unsigned int
+ms_list_model_get_n_items (GListModel *list)
+{
+  MsHeadTracker *self = MS_HEAD_TRACKER (list);
+
+  return self->heads->len;
+}
+
+
+static void
+ms_list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = ms_list_model_get_item_type;
+  iface->get_item = ms_list_model_get_item;
+  iface->get_n_items = ms_list_model_get_n_items;
+}
+
+
 static void
 ms_head_tracker_set_property (GObject      *object,
                               guint         property_id,
@@ -407,6 +563,8 @@ ms_head_tracker_finalize (GObject *object)
 
   g_clear_pointer (&self->heads, g_ptr_array_unref);
   g_clear_pointer (&self->heads_added, g_ptr_array_unref);
+  g_clear_pointer (&self->heads_removed, g_ptr_array_unref);
+  g_clear_pointer (&self->heads_modified, g_ptr_array_unref);
 
   G_OBJECT_CLASS (ms_head_tracker_parent_class)->finalize (object);
 }
@@ -428,35 +586,38 @@ ms_head_tracker_class_init (MsHeadTrackerClass *klass)
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 
-  signals[HEAD_ADDED] = g_signal_new ("head-added",
-                                      G_TYPE_FROM_CLASS (klass),
-                                      G_SIGNAL_RUN_LAST,
-                                      0, /* class offset */
-                                      NULL, /* accumulator */
-                                      NULL, /* accu_data */
-                                      NULL, /* marshaller */
-                                      G_TYPE_NONE, /* return */
-                                      1, /* n_params */
-                                      MS_TYPE_HEAD);
-
-  signals[HEAD_REMOVED] = g_signal_new ("head-removed",
-                                        G_TYPE_FROM_CLASS (klass),
-                                        G_SIGNAL_RUN_LAST,
-                                        0, /* class_offset */
-                                        NULL, /* accumulator */
-                                        NULL, /* accu_data */
-                                        NULL, /* marshaller */
-                                        G_TYPE_NONE, /* return */
-                                        1, /* n_params */
-                                        MS_TYPE_HEAD);
+  /**
+   * MsHeadTracker::changed:
+   * @self: The head tracker
+   * @added: (element-type MsHead): The heads that got added
+   * @removed: (element-type MsHead): The heads that got removed
+   * @modified: (element-type MsHead): The heads whose properties changed
+   *
+   * Emitted once per output configuration change after the list
+   * model got updated.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, /* class offset */
+                                   NULL, /* accumulator */
+                                   NULL, /* accu_data */
+                                   NULL, /* marshaller */
+                                   G_TYPE_NONE, /* return */
+                                   3, /* n_params */
+                                   G_TYPE_PTR_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE,
+                                   G_TYPE_PTR_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE,
+                                   G_TYPE_PTR_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 
 static void
 ms_head_tracker_init (MsHeadTracker *self)
 {
-  self->heads = g_ptr_array_new_full (1, (GDestroyNotify) ms_head_unref);
-  self->heads_added = g_ptr_array_new_full (1, (GDestroyNotify) ms_head_unref);
+  self->heads = g_ptr_array_new_with_free_func (g_object_unref);
+  self->heads_added = g_ptr_array_new_with_free_func (g_object_unref);
+  self->heads_removed = g_ptr_array_new_with_free_func (g_object_unref);
+  self->heads_modified = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 
@@ -481,21 +642,16 @@ ms_head_tracker_get_heads (MsHeadTracker *self)
 MsHead *
 ms_head_ref (MsHead *self)
 {
-  g_return_val_if_fail (self != NULL, NULL);
-  g_return_val_if_fail (self->ref_count, NULL);
-
-  g_atomic_ref_count_inc (&self->ref_count);
+  g_return_val_if_fail (MS_IS_HEAD (self), NULL);
 
-  return self;
+  return g_object_ref (self);
 }
 
 
 void
 ms_head_unref (MsHead *self)
 {
-  g_return_if_fail (self != NULL);
-  g_return_if_fail (self->ref_count);
+  g_return_if_fail (MS_IS_HEAD (self));
 
-  if (g_atomic_ref_count_dec (&self->ref_count))
-    ms_head_destroy (self);
+  g_object_unref (self);
 }
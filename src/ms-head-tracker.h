@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -14,8 +14,12 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (MsHeadTracker, ms_head_tracker, MS, HEAD_TRACKER, GObject)
 
-typedef struct {
-  gatomicrefcount      ref_count;
+#define MS_TYPE_HEAD (ms_head_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsHead, ms_head, MS, HEAD, GObject)
+
+struct _MsHead {
+  GObject              parent;
 
   char                *name;
   char                *make;
@@ -37,10 +41,7 @@ typedef struct {
   struct zwlr_output_mode_v1 *current_mode;
   struct zwlr_output_head_v1 *head;
   MsHeadTracker *tracker;
-} MsHead;
-
-GType ms_head_get_type (void) G_GNUC_CONST;
-#define MS_TYPE_HEAD (ms_head_get_type ())
+};
 
 MsHead *ms_head_ref (MsHead *self);
 void    ms_head_unref (MsHead *self);
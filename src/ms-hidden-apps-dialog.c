@@ -42,10 +42,17 @@ struct _MsHiddenAppsDialog {
   GtkStack   *stack;
   GtkListBox *hidden_apps_listbox;
 
-  GListStore *hidden_apps;
-  guint       n_selected;
+  GListStore   *hidden_apps;
+  guint         n_selected;
+  GCancellable *cancel;
 };
 
+typedef struct {
+  char *filename;
+  char *name;
+  char *icon_name;
+} MsHiddenApp;
+
 G_DEFINE_TYPE (MsHiddenAppsDialog, ms_hidden_apps_dialog, ADW_TYPE_DIALOG)
 
 
@@ -141,24 +148,92 @@ transform_n_items_to_stack_page_name (GBinding     *binding,
 }
 
 
+static void
+hidden_app_free (MsHiddenApp *app)
+{
+  g_free (app->filename);
+  g_free (app->name);
+  g_free (app->icon_name);
+  g_free (app);
+}
+
+
 static int
-compare_app_row (gconstpointer a, gconstpointer b, gpointer user_data)
+compare_hidden_app (gconstpointer a, gconstpointer b)
 {
-  AdwPreferencesRow *rowA = (gpointer)a;
-  AdwPreferencesRow *rowB = (gpointer)b;
+  const MsHiddenApp *appA = a;
+  const MsHiddenApp *appB = b;
 
-  return g_strcmp0 (adw_preferences_row_get_title (rowA),
-                    adw_preferences_row_get_title (rowB));
+  return g_strcmp0 (appA->name, appB->name);
 }
 
 
+static MsHiddenApp *
+load_hidden_app (const char *appdir, const char *filename)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autofree char *icon_name = NULL, *desktopfile = NULL, *name = NULL, *contents = NULL;
+  MsHiddenApp *app;
+  gsize len;
+
+  desktopfile = g_build_filename (appdir, filename, NULL);
+  if (!g_file_get_contents (desktopfile, &contents, &len, &err)) {
+    g_warning ("Failed to load desktop file '%s': %s", filename, err->message);
+    return NULL;
+  }
+
+  /* Most desktop files aren't ours, avoid parsing them */
+  if (!g_strstr_len (contents, len, "X-Phosh-Hidden")) {
+    g_debug ("Not hidden by phosh: %s", filename);
+    return NULL;
+  }
+
+  if (g_key_file_load_from_data (keyfile, contents, len, G_KEY_FILE_NONE, &err) == FALSE) {
+    g_warning ("Failed to load desktop file '%s': %s", filename, err->message);
+    return NULL;
+  }
+
+  if (!g_key_file_has_key (keyfile, "Desktop Entry", "X-Phosh-Hidden", &err)) {
+    g_debug ("Not hidden by phosh: %s: %s", filename, err ? err->message : "");
+    return NULL;
+  }
+
+  if (!g_key_file_has_key (keyfile, "Desktop Entry", "Hidden", &err)) {
+    g_warning ("No Hidden key found: %s: %s", filename, err ? err->message : "");
+    return NULL;
+  }
+
+  name = g_key_file_get_string (keyfile, "Desktop Entry", "Name", &err);
+  if (!name) {
+    g_warning ("No Name, desktop file unusable: %s: %s", filename, err ? err->message : "");
+    return NULL;
+  }
+
+  icon_name = g_key_file_get_string (keyfile, "Desktop Entry", "Icon", NULL);
+  if (!icon_name) {
+    g_warning ("No icon found: %s", filename);
+    /* We show it anyway */
+  }
+
+  app = g_new0 (MsHiddenApp, 1);
+  app->filename = g_steal_pointer (&desktopfile);
+  app->name = g_steal_pointer (&name);
+  app->icon_name = g_steal_pointer (&icon_name);
+
+  return app;
+}
+
 
 static void
-ms_hidden_apps_dialog_load_hidden_apps (MsHiddenAppsDialog *self)
+load_hidden_apps_in_thread (GTask        *task,
+                            gpointer      source_object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
 {
   g_autoptr (GError) err = NULL;
   g_autoptr (GDir) dir = NULL;
-  g_auto (GStrv) enabled_plugins = NULL;
+  g_autoptr (GPtrArray) apps = NULL;
   g_autofree char *appdir = NULL;
   const char *datadir, *filename;
 
@@ -168,55 +243,77 @@ ms_hidden_apps_dialog_load_hidden_apps (MsHiddenAppsDialog *self)
   appdir = g_build_filename (datadir, "applications", NULL);
   dir = g_dir_open (appdir, 0, &err);
   if (dir == NULL) {
-    g_warning ("Failed to read hidden apps %s: %s", appdir, err->message);
+    g_task_return_prefixed_error (task, g_steal_pointer (&err), "Failed to read hidden apps %s: ", appdir);
     return;
   }
 
+  apps = g_ptr_array_new_with_free_func ((GDestroyNotify) hidden_app_free);
   while ((filename = g_dir_read_name (dir))) {
-    GtkWidget *row;
-    g_autoptr (GError) error = NULL;
-    g_autoptr (GKeyFile) keyfile = g_key_file_new ();
-    g_autofree char *icon_name = NULL, *desktopfile = NULL, *name = NULL;
+    MsHiddenApp *app;
+
+    if (g_task_return_error_if_cancelled (task))
+      return;
 
     if (!g_str_has_suffix (filename, ".desktop"))
       continue;
 
-    desktopfile = g_build_filename (appdir, filename, NULL);
-    if (g_key_file_load_from_file (keyfile, desktopfile, G_KEY_FILE_NONE, &error) == FALSE) {
-      g_warning ("Failed to load desktop file '%s': %s", filename, error->message);
-      continue;
-    }
+    app = load_hidden_app (appdir, filename);
+    if (app)
+      g_ptr_array_add (apps, app);
+  }
 
-    if (!g_key_file_has_key (keyfile, "Desktop Entry", "X-Phosh-Hidden", &err)) {
-      g_debug ("Not hidden by phosh: %s: %s", filename, err ? err->message : "");
-      continue;
-    }
+  g_ptr_array_sort_values (apps, compare_hidden_app);
 
-    if (!g_key_file_has_key (keyfile, "Desktop Entry", "Hidden", &err)) {
-      g_warning ("No Hidden key found: %s: %s", filename, err ? err->message : "");
-      continue;
-    }
+  g_task_return_pointer (task, g_steal_pointer (&apps), (GDestroyNotify) g_ptr_array_unref);
+}
 
-    name = g_key_file_get_string (keyfile, "Desktop Entry", "Name", &err);
-    if (!name) {
-      g_warning ("No Name, desktop file unusable: %s: %s", filename, err ? err->message : "");
-      continue;
-    }
 
-    icon_name = g_key_file_get_string (keyfile, "Desktop Entry", "Icon", NULL);
-    if (!icon_name) {
-      g_warning ("No icon found: %s: %s", filename, err ? err->message : "");
-      /* We show it anyway */
-    }
+static void
+on_hidden_apps_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsHiddenAppsDialog *self;
+  g_autoptr (GPtrArray) apps = NULL;
+  g_autoptr (GPtrArray) rows = NULL;
+  g_autoptr (GError) err = NULL;
+
+  apps = g_task_propagate_pointer (G_TASK (res), &err);
+  if (apps == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("%s", err->message);
+    return;
+  }
+
+  self = MS_HIDDEN_APPS_DIALOG (source_object);
+
+  rows = g_ptr_array_sized_new (apps->len);
+  for (guint i = 0; i < apps->len; i++) {
+    MsHiddenApp *app = g_ptr_array_index (apps, i);
+    GtkWidget *row;
 
     row = g_object_new (MS_TYPE_HIDDEN_APP_ROW,
-                        "filename", desktopfile,
-                        "title", name,
-                        "icon-name", icon_name,
+                        "filename", app->filename,
+                        "title", app->name,
+                        "icon-name", app->icon_name,
                         NULL);
-
-    g_list_store_insert_sorted (self->hidden_apps, row, compare_app_row, NULL);
+    g_ptr_array_add (rows, row);
   }
+
+  g_debug ("Found %u hidden apps", rows->len);
+  g_list_store_splice (self->hidden_apps, 0, 0, rows->pdata, rows->len);
+}
+
+/*
+ * Scan the user's desktop files in a thread as there can be lots of them
+ * and add the hidden ones in one go.
+ */
+static void
+ms_hidden_apps_dialog_load_hidden_apps (MsHiddenAppsDialog *self)
+{
+  g_autoptr (GTask) task = NULL;
+
+  task = g_task_new (self, self->cancel, on_hidden_apps_loaded, NULL);
+  g_task_set_source_tag (task, ms_hidden_apps_dialog_load_hidden_apps);
+  g_task_run_in_thread (task, load_hidden_apps_in_thread);
 }
 
 
@@ -245,6 +342,8 @@ ms_hidden_apps_dialog_dispose (GObject *object)
 {
   MsHiddenAppsDialog *self = MS_HIDDEN_APPS_DIALOG (object);
 
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
   g_clear_object (&self->hidden_apps);
 
   G_OBJECT_CLASS (ms_hidden_apps_dialog_parent_class)->dispose (object);
@@ -330,6 +429,7 @@ ms_hidden_apps_dialog_init (MsHiddenAppsDialog *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  self->cancel = g_cancellable_new ();
   self->hidden_apps = g_list_store_new (G_TYPE_OBJECT);
 
   gtk_list_box_bind_model (self->hidden_apps_listbox,
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-indexed-list-store"
+
+#include "mobile-settings-config.h"
+
+#include "ms-indexed-list-store.h"
+
+/**
+ * MsIndexedListStore:
+ *
+ * A list model of items identified by a unique key. Additions and
+ * removals are collected and applied together from an idle callback
+ * so a burst of changes results in few `items-changed` emissions.
+ *
+ * Only the positions of removed items are touched, new items are
+ * appended at the end. Items that stay in the list are never replaced
+ * so widgets bound to them (e.g. list box rows) are kept.
+ */
+
+struct _MsIndexedListStore {
+  GObject                       parent;
+
+  GListStore                   *items;
+  /* The items' keys in list order, owns the keys */
+  GPtrArray                    *keys;
+  /* key → position in items */
+  GHashTable                   *index;
+
+  GPtrArray                    *pending_added;
+  GHashTable                   *pending_removed;
+  guint                         flush_id;
+
+  GEqualFunc                    equal_func;
+  GCopyFunc                     key_copy_func;
+  GDestroyNotify                key_destroy_func;
+  MsIndexedListStoreCreateFunc  create_func;
+  gpointer                      user_data;
+};
+
+static void ms_indexed_list_store_list_model_iface_init (GListModelInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MsIndexedListStore, ms_indexed_list_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
+                                                ms_indexed_list_store_list_model_iface_init))
+
+
+static GType
+ms_indexed_list_store_get_item_type (GListModel *list)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (list);
+
+  return g_list_model_get_item_type (G_LIST_MODEL (self->items));
+}
+
+
+static gpointer
+ms_indexed_list_store_get_item (GListModel *list, guint position)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (list);
+
+  return g_list_model_get_item (G_LIST_MODEL (self->items), position);
+}
+
+
+static guint
+ms_indexed_list_store_get_n_items (GListModel *list)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (list);
+
+  return g_list_model_get_n_items (G_LIST_MODEL (self->items));
+}
+
+
+static void
+ms_indexed_list_store_list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = ms_indexed_list_store_get_item_type;
+  iface->get_item = ms_indexed_list_store_get_item;
+  iface->get_n_items = ms_indexed_list_store_get_n_items;
+}
+
+
+static gpointer
+copy_key (MsIndexedListStore *self, gconstpointer key)
+{
+  if (self->key_copy_func)
+    return self->key_copy_func (key, NULL);
+
+  return (gpointer) key;
+}
+
+
+static void
+reindex (MsIndexedListStore *self, guint from)
+{
+  for (guint i = from; i < self->keys->len; i++)
+    g_hash_table_insert (self->index, g_ptr_array_index (self->keys, i), GUINT_TO_POINTER (i));
+}
+
+
+static int
+compare_positions (gconstpointer a, gconstpointer b)
+{
+  guint pos_a = *(const guint *) a;
+  guint pos_b = *(const guint *) b;
+
+  return (pos_a > pos_b) - (pos_a < pos_b);
+}
+
+
+static void
+flush_removed (MsIndexedListStore *self)
+{
+  g_autoptr (GArray) positions = g_array_new (FALSE, FALSE, sizeof (guint));
+  GHashTableIter iter;
+  gpointer key, pos;
+  guint end;
+
+  g_hash_table_iter_init (&iter, self->pending_removed);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    if (g_hash_table_lookup_extended (self->index, key, NULL, &pos)) {
+      guint position = GPOINTER_TO_UINT (pos);
+
+      g_array_append_val (positions, position);
+    }
+  }
+  g_hash_table_remove_all (self->pending_removed);
+
+  if (positions->len == 0)
+    return;
+
+  g_array_sort (positions, compare_positions);
+
+  /* Remove contiguous runs back to front so earlier positions stay valid */
+  end = positions->len;
+  while (end > 0) {
+    guint start = end - 1;
+    guint first, n;
+
+    while (start > 0 &&
+           g_array_index (positions, guint, start - 1) + 1 == g_array_index (positions, guint, start))
+      start--;
+
+    first = g_array_index (positions, guint, start);
+    n = end - start;
+    for (guint i = first; i < first + n; i++)
+      g_hash_table_remove (self->index, g_ptr_array_index (self->keys, i));
+    g_ptr_array_remove_range (self->keys, first, n);
+    g_list_store_splice (self->items, first, n, NULL, 0);
+
+    end = start;
+  }
+
+  reindex (self, g_array_index (positions, guint, 0));
+}
+
+
+static void
+flush_added (MsIndexedListStore *self)
+{
+  g_autoptr (GPtrArray) items = g_ptr_array_new_with_free_func (g_object_unref);
+  guint n_items = self->keys->len;
+
+  for (guint i = 0; i < self->pending_added->len; i++) {
+    gpointer key = g_ptr_array_index (self->pending_added, i);
+    gpointer item = self->create_func (key, self->user_data);
+
+    if (item == NULL)
+      continue;
+
+    g_ptr_array_add (items, item);
+    g_ptr_array_add (self->keys, g_steal_pointer (&self->pending_added->pdata[i]));
+  }
+  g_ptr_array_set_size (self->pending_added, 0);
+
+  if (items->len == 0)
+    return;
+
+  reindex (self, n_items);
+  g_list_store_splice (self->items, n_items, 0, items->pdata, items->len);
+}
+
+
+static gboolean
+on_flush (gpointer user_data)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (user_data);
+
+  self->flush_id = 0;
+
+  g_debug ("%u added, %u removed",
+           self->pending_added->len, g_hash_table_size (self->pending_removed));
+
+  flush_removed (self);
+  flush_added (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_flush (MsIndexedListStore *self)
+{
+  if (self->flush_id)
+    return;
+
+  self->flush_id = g_idle_add (on_flush, self);
+  g_source_set_name_by_id (self->flush_id, "[ms] flush indexed list store");
+}
+
+
+static void
+on_items_changed (MsIndexedListStore *self, guint position, guint removed, guint added)
+{
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+
+static void
+ms_indexed_list_store_dispose (GObject *object)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (object);
+
+  g_clear_handle_id (&self->flush_id, g_source_remove);
+
+  G_OBJECT_CLASS (ms_indexed_list_store_parent_class)->dispose (object);
+}
+
+
+static void
+ms_indexed_list_store_finalize (GObject *object)
+{
+  MsIndexedListStore *self = MS_INDEXED_LIST_STORE (object);
+
+  g_clear_object (&self->items);
+  g_clear_pointer (&self->index, g_hash_table_destroy);
+  g_clear_pointer (&self->keys, g_ptr_array_unref);
+  g_clear_pointer (&self->pending_added, g_ptr_array_unref);
+  g_clear_pointer (&self->pending_removed, g_hash_table_destroy);
+
+  G_OBJECT_CLASS (ms_indexed_list_store_parent_class)->finalize (object);
+}
+
+
+static void
+ms_indexed_list_store_class_init (MsIndexedListStoreClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ms_indexed_list_store_dispose;
+  object_class->finalize = ms_indexed_list_store_finalize;
+}
+
+
+static void
+ms_indexed_list_store_init (MsIndexedListStore *self)
+{
+}
+
+/**
+ * ms_indexed_list_store_new:
+ * @item_type: The type of the items
+ * @hash_func: Hash function for the keys
+ * @equal_func: Equal function for the keys
+ * @key_copy_func:(nullable): Function to copy keys, %NULL to use them as is
+ * @key_destroy_func:(nullable): Function to free copied keys
+ * @create_func: Function creating the item for a key
+ * @user_data: User data for @create_func
+ *
+ * Returns: A new, empty store
+ */
+MsIndexedListStore *
+ms_indexed_list_store_new (GType                         item_type,
+                           GHashFunc                     hash_func,
+                           GEqualFunc                    equal_func,
+                           GCopyFunc                     key_copy_func,
+                           GDestroyNotify                key_destroy_func,
+                           MsIndexedListStoreCreateFunc  create_func,
+                           gpointer                      user_data)
+{
+  MsIndexedListStore *self;
+
+  g_return_val_if_fail (create_func, NULL);
+
+  self = g_object_new (MS_TYPE_INDEXED_LIST_STORE, NULL);
+
+  self->equal_func = equal_func;
+  self->key_copy_func = key_copy_func;
+  self->key_destroy_func = key_destroy_func;
+  self->create_func = create_func;
+  self->user_data = user_data;
+
+  self->items = g_list_store_new (item_type);
+  self->keys = g_ptr_array_new_with_free_func (key_destroy_func);
+  self->index = g_hash_table_new (hash_func, equal_func);
+  self->pending_added = g_ptr_array_new_with_free_func (key_destroy_func);
+  self->pending_removed = g_hash_table_new_full (hash_func, equal_func, key_destroy_func, NULL);
+
+  g_signal_connect_swapped (self->items, "items-changed", G_CALLBACK (on_items_changed), self);
+
+  return self;
+}
+
+/**
+ * ms_indexed_list_store_add:
+ * @self: The store
+ * @key: The key of the item to add
+ *
+ * Queue the item for @key to be added at the end of the list. Adding a
+ * key that is already present does nothing.
+ */
+void
+ms_indexed_list_store_add (MsIndexedListStore *self, gconstpointer key)
+{
+  g_return_if_fail (MS_IS_INDEXED_LIST_STORE (self));
+
+  /* Still in the list, just don't remove it */
+  if (g_hash_table_remove (self->pending_removed, key))
+    return;
+
+  if (g_hash_table_contains (self->index, key) ||
+      g_ptr_array_find_with_equal_func (self->pending_added, key, self->equal_func, NULL))
+    return;
+
+  g_ptr_array_add (self->pending_added, copy_key (self, key));
+  schedule_flush (self);
+}
+
+/**
+ * ms_indexed_list_store_remove:
+ * @self: The store
+ * @key: The key of the item to remove
+ *
+ * Queue the item for @key for removal.
+ */
+void
+ms_indexed_list_store_remove (MsIndexedListStore *self, gconstpointer key)
+{
+  guint index;
+
+  g_return_if_fail (MS_IS_INDEXED_LIST_STORE (self));
+
+  /* Not in the list yet, just don't add it */
+  if (g_ptr_array_find_with_equal_func (self->pending_added, key, self->equal_func, &index)) {
+    g_ptr_array_remove_index (self->pending_added, index);
+    return;
+  }
+
+  if (!g_hash_table_contains (self->index, key)) {
+    g_debug ("Item not present, can't remove");
+    return;
+  }
+
+  g_hash_table_add (self->pending_removed, copy_key (self, key));
+  schedule_flush (self);
+}
+
+/**
+ * ms_indexed_list_store_contains:
+ * @self: The store
+ * @key: The key to look up
+ *
+ * Returns: %TRUE if the item for @key is currently in the list
+ */
+gboolean
+ms_indexed_list_store_contains (MsIndexedListStore *self, gconstpointer key)
+{
+  g_return_val_if_fail (MS_IS_INDEXED_LIST_STORE (self), FALSE);
+
+  return g_hash_table_contains (self->index, key);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * MsIndexedListStoreCreateFunc:
+ * @key: The key of the item to create
+ * @user_data: The user data passed to ms_indexed_list_store_new()
+ *
+ * Returns:(transfer full)(nullable): The item for @key or %NULL to skip it
+ */
+typedef gpointer (*MsIndexedListStoreCreateFunc) (gconstpointer key, gpointer user_data);
+
+#define MS_TYPE_INDEXED_LIST_STORE (ms_indexed_list_store_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsIndexedListStore, ms_indexed_list_store, MS, INDEXED_LIST_STORE, GObject)
+
+MsIndexedListStore *ms_indexed_list_store_new      (GType                         item_type,
+                                                    GHashFunc                     hash_func,
+                                                    GEqualFunc                    equal_func,
+                                                    GCopyFunc                     key_copy_func,
+                                                    GDestroyNotify                key_destroy_func,
+                                                    MsIndexedListStoreCreateFunc  create_func,
+                                                    gpointer                      user_data);
+void                ms_indexed_list_store_add      (MsIndexedListStore           *self,
+                                                    gconstpointer                 key);
+void                ms_indexed_list_store_remove   (MsIndexedListStore           *self,
+                                                    gconstpointer                 key);
+gboolean            ms_indexed_list_store_contains (MsIndexedListStore           *self,
+                                                    gconstpointer                 key);
+
+G_END_DECLS
@@ -13,6 +13,7 @@
 
 #include "mobile-settings-config.h"
 #include "ms-lang-panel.h"
+#include "ms-trace.h"
 #include "ms-util.h"
 
 #include "libpms.h"
@@ -48,6 +49,8 @@ struct _MsLangPanel {
   GCancellable      *cancel;
   GDBusProxy        *localed;
   GPermission       *localed_perm;
+  gint64             bus_begin;
+  gint64             perm_begin;
 
   AdwToastOverlay   *toast_overlay;
 };
@@ -327,20 +330,23 @@ ms_lang_panel_get_user_lang (MsLangPanel *self)
 
 
 static void
-ms_lang_panel_init_localed (MsLangPanel *self)
+on_localed_perm_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-  g_autoptr (GDBusConnection) bus = NULL;
+  MsLangPanel *self;
+  GPermission *perm;
   g_autoptr (GError) err = NULL;
 
-  self->localed_perm = polkit_permission_new_sync ("org.freedesktop.locale1.set-locale",
-                                                   NULL,
-                                                   NULL,
-                                                   &err);
-  if (self->localed_perm == NULL) {
-    g_warning ("Could not get localed set-locale permission: %s", err->message);
+  perm = polkit_permission_new_finish (res, &err);
+  if (perm == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Could not get localed set-locale permission: %s", err->message);
     return;
   }
 
+  self = MS_LANG_PANEL (user_data);
+  self->localed_perm = perm;
+  ms_trace_end (self->perm_begin, "dbus-proxy", "polkit");
+
   g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
                             G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
                             NULL,
@@ -353,6 +359,18 @@ ms_lang_panel_init_localed (MsLangPanel *self)
 }
 
 
+static void
+ms_lang_panel_init_localed (MsLangPanel *self)
+{
+  self->perm_begin = ms_trace_begin ();
+  polkit_permission_new ("org.freedesktop.locale1.set-locale",
+                         NULL,
+                         self->cancel,
+                         on_localed_perm_ready,
+                         self);
+}
+
+
 static void
 ms_lang_panel_init_accountsservice (MsLangPanel *self)
 {
@@ -371,6 +389,33 @@ ms_lang_panel_init_accountsservice (MsLangPanel *self)
 }
 
 
+static void
+on_system_bus_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsLangPanel *self;
+  g_autoptr (GDBusConnection) conn = NULL;
+  g_autoptr (GError) err = NULL;
+
+  conn = g_bus_get_finish (res, &err);
+  if (conn == NULL && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = MS_LANG_PANEL (user_data);
+  ms_trace_end (self->bus_begin, "dbus-proxy", "system-bus");
+
+  /* Avoid warning in tests when there's no system bus */
+  if (conn) {
+    ms_lang_panel_init_accountsservice (self);
+    ms_lang_panel_init_localed (self);
+  } else {
+    g_debug ("No system bus: %s", err->message);
+  }
+
+  ms_lang_panel_get_user_lang (self);
+  ms_panel_set_ready (MS_PANEL (self), TRUE);
+}
+
+
 static void
 ms_lang_panel_finalize (GObject *object)
 {
@@ -421,20 +466,13 @@ ms_lang_panel_class_init (MsLangPanelClass *klass)
 static void
 ms_lang_panel_init (MsLangPanel *self)
 {
-  g_autoptr (GDBusConnection) conn = NULL;
-
   gtk_widget_init_template (GTK_WIDGET (self));
 
   self->cancel = g_cancellable_new ();
 
-  /* Avoid warning in tests when there's no system bus */
-  conn = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
-  if (conn) {
-    ms_lang_panel_init_accountsservice (self);
-    ms_lang_panel_init_localed (self);
-  }
-
-  ms_lang_panel_get_user_lang (self);
+  ms_panel_set_ready (MS_PANEL (self), FALSE);
+  self->bus_begin = ms_trace_begin ();
+  g_bus_get (G_BUS_TYPE_SYSTEM, self->cancel, on_system_bus_ready, self);
 }
 
 
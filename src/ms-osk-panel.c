@@ -13,6 +13,7 @@
 #include "ms-completer-info.h"
 #include "ms-osk-add-shortcut-dialog.h"
 #include "ms-osk-panel.h"
+#include "ms-trace.h"
 #include "ms-util.h"
 
 #include "libpms.h"
@@ -80,6 +81,9 @@ typedef enum {
 struct _MsOskPanel {
   MsPanel              parent;
 
+  GCancellable        *cancel;
+  gint64               osk_app_begin;
+
   GSettings           *a11y_settings;
   GtkWidget           *osk_enable_switch;
   GtkWidget           *osk_layout_prefs;
@@ -450,72 +454,6 @@ on_osk_scaling_switch_changed (MsOskPanel *self, GParamSpec *spec, AdwSwitchRow
 }
 
 
-static MsOskApp
-is_osk_app (void)
-{
-  g_autoptr (GError) error = NULL;
-  g_autoptr (GDBusProxy) proxy = NULL;
-  g_autoptr (GVariant) ret = NULL;
-  g_autofree char *proc_path = NULL;
-  g_autofree char *exe = NULL;
-  guint32 pid;
-  const char *forced_osk;
-
-  forced_osk = g_getenv ("MS_FORCE_OSK");
-  if (forced_osk) {
-    if (g_str_equal (forced_osk, "pos"))
-      return MS_OSK_APP_POS;
-    else if (g_str_equal (forced_osk, "squeekboard"))
-      return MS_OSK_APP_SQUEEKBOARD;
-    else
-      return MS_OSK_APP_UNKNOWN;
-  }
-
-  proxy =  g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                          G_DBUS_PROXY_FLAGS_NONE,
-                                          NULL,
-                                          "org.freedesktop.DBus",
-                                          "/org/freesktop/DBus",
-                                          "org.freedesktop.DBus",
-                                          NULL,
-                                          &error);
-  if (proxy == NULL) {
-    g_warning ("Failed to query dbus: %s", error->message);
-    return MS_OSK_APP_UNKNOWN;
-  }
-
-  ret = g_dbus_proxy_call_sync (proxy,
-                                "GetConnectionUnixProcessID",
-                                g_variant_new ("(s)", PHOSH_OSK_DBUS_NAME),
-                                G_DBUS_CALL_FLAGS_NONE,
-                                1000,
-                                NULL,
-                                &error);
-  if (proxy == NULL || ret == NULL) {
-    g_debug ("Failed to query osk pid: %s", error->message);
-    return MS_OSK_APP_UNKNOWN;
-  }
-
-  g_variant_get (ret, "(u)", &pid);
-  proc_path = g_strdup_printf ("/proc/%d/exe", pid);
-
-  exe = g_file_read_link (proc_path, &error);
-  if (exe == NULL) {
-    g_warning ("Failed to query osk exe: %s", error->message);
-    return MS_OSK_APP_UNKNOWN;
-  }
-
-  if (g_str_has_suffix (exe, "/phosh-osk-stevia") ||
-      g_str_has_suffix (exe, "/phosh-osk-stevia (deleted)"))
-    return MS_OSK_APP_POS;
-  else if (g_str_has_suffix (exe, "/squeekboard") ||
-           g_str_has_suffix (exe, "/squeekboard (deleted)"))
-    return MS_OSK_APP_SQUEEKBOARD;
-
-  return MS_OSK_APP_UNKNOWN;
-}
-
-
 static void
 on_new_shortcut_clicked (MsOskPanel *self)
 {
@@ -564,6 +502,18 @@ on_reset_terminal_shortcuts_activated (GtkWidget  *widget,
 }
 
 
+static void
+ms_osk_panel_dispose (GObject *object)
+{
+  MsOskPanel *self = MS_OSK_PANEL (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+
+  G_OBJECT_CLASS (ms_osk_panel_parent_class)->dispose (object);
+}
+
+
 static void
 ms_osk_panel_finalize (GObject *object)
 {
@@ -589,6 +539,7 @@ ms_osk_panel_class_init (MsOskPanelClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+  object_class->dispose = ms_osk_panel_dispose;
   object_class->finalize = ms_osk_panel_finalize;
 
   gtk_widget_class_set_template_from_resource (widget_class,
@@ -942,11 +893,146 @@ ms_osk_panel_init_squeek (MsOskPanel *self)
 }
 
 
+static void
+on_osk_app_detected (MsOskPanel *self, MsOskApp osk_app)
+{
+  ms_trace_end (self->osk_app_begin, "dbus-proxy", "osk");
+
+  if (osk_app == MS_OSK_APP_SQUEEKBOARD)
+    ms_osk_panel_init_squeek (self);
+  else
+    ms_osk_panel_init_pos (self);
+
+  ms_panel_set_ready (MS_PANEL (self), TRUE);
+}
+
+
+static MsOskApp
+get_osk_app_from_pid (guint32 pid)
+{
+  g_autoptr (GError) error = NULL;
+  g_autofree char *proc_path = NULL;
+  g_autofree char *exe = NULL;
+
+  proc_path = g_strdup_printf ("/proc/%d/exe", pid);
+
+  exe = g_file_read_link (proc_path, &error);
+  if (exe == NULL) {
+    g_warning ("Failed to query osk exe: %s", error->message);
+    return MS_OSK_APP_UNKNOWN;
+  }
+
+  if (g_str_has_suffix (exe, "/phosh-osk-stevia") ||
+      g_str_has_suffix (exe, "/phosh-osk-stevia (deleted)"))
+    return MS_OSK_APP_POS;
+  else if (g_str_has_suffix (exe, "/squeekboard") ||
+           g_str_has_suffix (exe, "/squeekboard (deleted)"))
+    return MS_OSK_APP_SQUEEKBOARD;
+
+  return MS_OSK_APP_UNKNOWN;
+}
+
+
+static void
+on_get_osk_pid_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsOskPanel *self;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GVariant) ret = NULL;
+  MsOskApp osk_app = MS_OSK_APP_UNKNOWN;
+  guint32 pid;
+
+  ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (ret == NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = MS_OSK_PANEL (user_data);
+
+  if (ret) {
+    g_variant_get (ret, "(u)", &pid);
+    osk_app = get_osk_app_from_pid (pid);
+  } else {
+    g_debug ("Failed to query osk pid: %s", error->message);
+  }
+
+  on_osk_app_detected (self, osk_app);
+}
+
+
+static void
+on_dbus_proxy_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsOskPanel *self;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GDBusProxy) proxy = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (res, &error);
+  if (proxy == NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = MS_OSK_PANEL (user_data);
+
+  if (proxy == NULL) {
+    g_warning ("Failed to query dbus: %s", error->message);
+    on_osk_app_detected (self, MS_OSK_APP_UNKNOWN);
+    return;
+  }
+
+  g_dbus_proxy_call (proxy,
+                     "GetConnectionUnixProcessID",
+                     g_variant_new ("(s)", PHOSH_OSK_DBUS_NAME),
+                     G_DBUS_CALL_FLAGS_NONE,
+                     1000,
+                     self->cancel,
+                     on_get_osk_pid_ready,
+                     self);
+}
+
+/*
+ * Figure out which OSK is running. Only the OSK specific parts of the
+ * panel depend on this so we show the rest right away.
+ */
+static void
+detect_osk_app (MsOskPanel *self)
+{
+  const char *forced_osk;
+
+  self->osk_app_begin = ms_trace_begin ();
+  ms_panel_set_ready (MS_PANEL (self), FALSE);
+
+  forced_osk = g_getenv ("MS_FORCE_OSK");
+  if (forced_osk) {
+    MsOskApp osk_app = MS_OSK_APP_UNKNOWN;
+
+    if (g_str_equal (forced_osk, "pos"))
+      osk_app = MS_OSK_APP_POS;
+    else if (g_str_equal (forced_osk, "squeekboard"))
+      osk_app = MS_OSK_APP_SQUEEKBOARD;
+
+    on_osk_app_detected (self, osk_app);
+    return;
+  }
+
+  g_dbus_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                            G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                            G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+                            NULL,
+                            "org.freedesktop.DBus",
+                            "/org/freesktop/DBus",
+                            "org.freedesktop.DBus",
+                            self->cancel,
+                            on_dbus_proxy_ready,
+                            self);
+}
+
+
 static void
 ms_osk_panel_init (MsOskPanel *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  self->cancel = g_cancellable_new ();
+
   self->completer_infos = g_list_store_new (MS_TYPE_COMPLETER_INFO);
   self->a11y_settings = g_settings_new (A11Y_SETTINGS);
   g_settings_bind (self->a11y_settings, OSK_ENABLED_KEY,
@@ -961,10 +1047,7 @@ ms_osk_panel_init (MsOskPanel *self)
                                 self,
                                 NULL);
 
-  if (is_osk_app () == MS_OSK_APP_SQUEEKBOARD)
-    ms_osk_panel_init_squeek (self);
-  else
-    ms_osk_panel_init_pos (self);
+  detect_osk_app (self);
 }
 
 
@@ -12,6 +12,7 @@
 
 #include "mobile-settings-config.h"
 
+#include "ms-app-info-registry.h"
 #include "ms-overview-panel.h"
 #include "ms-hidden-apps-dialog.h"
 #include "ms-util.h"
@@ -116,7 +117,11 @@ on_reset_btn_clicked (GtkButton *reset_btn, MsOverviewPanel *self)
   adw_alert_dialog_set_default_response (ADW_ALERT_DIALOG (dialog), "cancel");
   adw_alert_dialog_set_close_response (ADW_ALERT_DIALOG (dialog), "cancel");
 
-  g_signal_connect_swapped (dialog, "response", G_CALLBACK (on_reset_favorites_response), self);
+  g_signal_connect_object (dialog,
+                           "response",
+                           G_CALLBACK (on_reset_favorites_response),
+                           self,
+                           G_CONNECT_SWAPPED);
   adw_dialog_present (dialog, GTK_WIDGET (self));
 }
 
@@ -314,26 +319,78 @@ create_fav_app (gpointer item, gpointer user_data)
   add_drag_source (app);
   add_drop_target (app, self);
 
-  g_object_set_data_full (G_OBJECT (app), "app-info", app_info, g_object_unref);
+  g_object_set_data_full (G_OBJECT (app), "app-info", g_object_ref (app_info), g_object_unref);
 
   return app;
 }
 
 
+static gboolean
+same_app (gconstpointer app1, gconstpointer app2)
+{
+  return g_strcmp0 (g_app_info_get_id (G_APP_INFO (app1)), g_app_info_get_id (G_APP_INFO (app2))) == 0;
+}
+
+/*
+ * Turn the current favorites into @apps touching as few items as
+ * possible so only the widgets of changed favorites get rebuilt.
+ */
+static void
+update_favorites (MsOverviewPanel *self, GPtrArray *old_apps, GPtrArray *new_apps)
+{
+  MsListDiff diff;
+  gpointer item;
+
+  diff = ms_util_diff_lists (old_apps->pdata, old_apps->len,
+                             new_apps->pdata, new_apps->len,
+                             same_app);
+  switch (diff.type) {
+  case MS_LIST_DIFF_NONE:
+    break;
+  case MS_LIST_DIFF_MOVE:
+    /* A favorite got dragged to a new position */
+    item = g_ptr_array_index (old_apps, diff.position);
+    g_list_store_remove (self->apps, diff.position);
+    g_list_store_insert (self->apps, diff.dest, item);
+    break;
+  case MS_LIST_DIFF_SPLICE:
+    g_list_store_splice (self->apps, diff.position, diff.n_removed,
+                         &new_apps->pdata[diff.position], diff.n_added);
+    break;
+  default:
+    g_assert_not_reached ();
+  }
+}
+
+
 static void
 on_favorites_changed (MsOverviewPanel *self)
 {
-  g_autoptr (GDesktopAppInfo) app_info = NULL;
+  MsAppInfoRegistry *registry = ms_app_info_registry_get_default ();
   g_auto (GStrv) fav_list = g_settings_get_strv (self->settings, FAVORITES_KEY);
+  g_autoptr (GPtrArray) old_apps = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr (GPtrArray) new_apps = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr (GHashTable) known = g_hash_table_new (g_str_hash, g_str_equal);
 
-  g_list_store_remove_all (self->apps);
+  for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->apps)); i++) {
+    GAppInfo *app_info = g_list_model_get_item (G_LIST_MODEL (self->apps), i);
+
+    g_ptr_array_add (old_apps, app_info);
+    g_hash_table_insert (known, (gpointer) g_app_info_get_id (app_info), app_info);
+  }
 
   for (int i = 0; fav_list[i]; ++i) {
-    app_info = g_desktop_app_info_new (fav_list[i]);
+    GAppInfo *app_info = g_hash_table_lookup (known, fav_list[i]);
+
+    /* Reuse the info of current favorites */
+    if (app_info == NULL)
+      app_info = G_APP_INFO (ms_app_info_registry_lookup (registry, fav_list[i]));
 
     if (app_info)
-      g_list_store_append (self->apps, app_info);
+      g_ptr_array_add (new_apps, g_object_ref (app_info));
   }
+
+  update_favorites (self, old_apps, new_apps);
 }
 
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-panel-factory"
+
+#include "mobile-settings-config.h"
+
+#include "ms-panel-factory.h"
+#include "ms-trace.h"
+#include "ms-about-panel.h"
+#include "ms-alerts-panel.h"
+#include "ms-compositor-panel.h"
+#include "ms-convergence-panel.h"
+#include "ms-features-panel.h"
+#include "ms-feedback-panel.h"
+#include "ms-lang-panel.h"
+#include "ms-lockscreen-panel.h"
+#include "ms-osk-panel.h"
+#include "ms-overview-panel.h"
+#include "ms-sensor-panel.h"
+#include "ms-topbar-panel.h"
+#include "ms-updates-panel.h"
+#include "ms-welcome-panel.h"
+
+#include "libpms.h"
+
+/*
+ * The built-in panels are only declared as placeholder `MsPanel`s in
+ * the window's view stack. The placeholder carries the metadata the
+ * sidebar needs (name, title, icon, keywords) and whether the panel
+ * is enabled. The actual panel is only built when it is shown and
+ * then becomes the placeholder's child.
+ */
+
+/**
+ * MsPanelInfo:
+ * @name: The panel's name in the view stack
+ * @get_type: The panel's type
+ * @setup_func: Optional function to hook up the placeholder's `enabled` property
+ *   without building the panel
+ * @heavy: Whether the panel uses a lot of memory and should be released
+ *   when not in use
+ */
+typedef struct _MsPanelInfo {
+  const char *name;
+  GType (*get_type) (void);
+  void (*setup_func) (MsPanel *placeholder);
+  gboolean heavy;
+} MsPanelInfo;
+
+
+static void
+setup_updates_panel (MsPanel *placeholder)
+{
+  MsOsUpdater *updater = ms_get_default_os_updater ();
+
+  g_object_bind_property (updater, "supported", placeholder, "enabled", G_BINDING_SYNC_CREATE);
+  g_object_set_data_full (G_OBJECT (placeholder), "ms-os-updater", updater, g_object_unref);
+}
+
+
+static const MsPanelInfo panel_info[] = {
+  { "welcome", ms_welcome_panel_get_type, NULL, FALSE },
+  { "topbar", ms_topbar_panel_get_type, NULL, FALSE },
+  { "overview", ms_overview_panel_get_type, NULL, TRUE },
+  { "feedback", ms_feedback_panel_get_type, NULL, TRUE },
+  { "compositor", ms_compositor_panel_get_type, NULL, TRUE },
+  { "lockscreen", ms_lockscreen_panel_get_type, NULL, FALSE },
+  { "convergence", ms_convergence_panel_get_type, NULL, FALSE },
+  { "osk", ms_osk_panel_get_type, NULL, TRUE },
+  { "alerts", ms_alerts_panel_get_type, NULL, FALSE },
+  { "sensors", ms_sensor_panel_get_type, NULL, FALSE },
+  { "features", ms_features_panel_get_type, NULL, FALSE },
+  { "language", ms_lang_panel_get_type, NULL, TRUE },
+  { "updates", ms_updates_panel_get_type, setup_updates_panel, FALSE },
+  { "about", ms_about_panel_get_type, NULL, FALSE },
+};
+
+
+static const MsPanelInfo *
+lookup_panel_info (const char *name)
+{
+  for (gsize i = 0; i < G_N_ELEMENTS (panel_info); i++) {
+    if (g_strcmp0 (panel_info[i].name, name) == 0)
+      return &panel_info[i];
+  }
+
+  return NULL;
+}
+
+/**
+ * ms_panel_factory_has_panel:
+ * @name: The panel name
+ *
+ * Returns: %TRUE if the factory knows how to build the panel
+ */
+gboolean
+ms_panel_factory_has_panel (const char *name)
+{
+  return lookup_panel_info (name) != NULL;
+}
+
+/**
+ * ms_panel_factory_setup:
+ * @name: The panel name
+ * @placeholder: The panel's placeholder in the view stack
+ *
+ * Set up the placeholder so its `enabled` property reflects the
+ * panel's state without building the panel.
+ */
+void
+ms_panel_factory_setup (const char *name, MsPanel *placeholder)
+{
+  const MsPanelInfo *info = lookup_panel_info (name);
+
+  g_return_if_fail (info);
+  g_return_if_fail (MS_IS_PANEL (placeholder));
+
+  if (info->setup_func)
+    info->setup_func (placeholder);
+}
+
+/**
+ * ms_panel_factory_ensure:
+ * @name: The panel name
+ * @placeholder: The panel's placeholder in the view stack
+ *
+ * Build the panel and add it to @placeholder unless that already
+ * happened.
+ *
+ * Returns:(transfer none): The panel
+ */
+MsPanel *
+ms_panel_factory_ensure (const char *name, MsPanel *placeholder)
+{
+  const MsPanelInfo *info = lookup_panel_info (name);
+  GtkWidget *panel;
+  gint64 begin;
+
+  g_return_val_if_fail (info, NULL);
+  g_return_val_if_fail (MS_IS_PANEL (placeholder), NULL);
+
+  panel = adw_bin_get_child (ADW_BIN (placeholder));
+  if (panel)
+    return MS_PANEL (panel);
+
+  g_debug ("Building panel '%s'", name);
+  begin = ms_trace_begin ();
+  panel = g_object_new (info->get_type (), NULL);
+  adw_bin_set_child (ADW_BIN (placeholder), panel);
+  g_object_bind_property (panel, "ready", placeholder, "ready", G_BINDING_SYNC_CREATE);
+  ms_trace_end (begin, "panel-init", name);
+
+  return MS_PANEL (panel);
+}
+
+/**
+ * ms_panel_factory_is_heavy:
+ * @name: The panel name
+ *
+ * Returns: %TRUE if the panel uses a lot of memory and should be
+ * released when not in use
+ */
+gboolean
+ms_panel_factory_is_heavy (const char *name)
+{
+  const MsPanelInfo *info = lookup_panel_info (name);
+
+  return info && info->heavy;
+}
+
+/**
+ * ms_panel_factory_release:
+ * @name: The panel name
+ * @placeholder: The panel's placeholder in the view stack
+ *
+ * Destroy the panel built for @placeholder. It will be built again
+ * via ms_panel_factory_ensure() when needed.
+ *
+ * Returns: %TRUE if a panel was released
+ */
+gboolean
+ms_panel_factory_release (const char *name, MsPanel *placeholder)
+{
+  g_return_val_if_fail (ms_panel_factory_has_panel (name), FALSE);
+  g_return_val_if_fail (MS_IS_PANEL (placeholder), FALSE);
+
+  if (adw_bin_get_child (ADW_BIN (placeholder)) == NULL)
+    return FALSE;
+
+  g_debug ("Releasing panel '%s'", name);
+  adw_bin_set_child (ADW_BIN (placeholder), NULL);
+  ms_panel_set_ready (placeholder, TRUE);
+
+  return TRUE;
+}
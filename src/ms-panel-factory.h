@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ms-panel.h"
+
+G_BEGIN_DECLS
+
+gboolean ms_panel_factory_has_panel  (const char *name);
+void     ms_panel_factory_setup      (const char *name, MsPanel *placeholder);
+MsPanel *ms_panel_factory_ensure     (const char *name, MsPanel *placeholder);
+gboolean ms_panel_factory_is_heavy   (const char *name);
+gboolean ms_panel_factory_release    (const char *name, MsPanel *placeholder);
+
+G_END_DECLS
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-panel-prewarmer"
+
+#include "mobile-settings-config.h"
+
+#include "ms-panel-factory.h"
+#include "ms-panel-prewarmer.h"
+
+/* Don't compete with the user for the main loop */
+#define INPUT_QUIET_US (250 * G_TIME_SPAN_MILLISECOND)
+#define DEFAULT_REFRESH_INTERVAL_US (G_USEC_PER_SEC / 60)
+
+/**
+ * MsPanelPrewarmer:
+ *
+ * Builds deferred panels when the main loop is idle so that opening
+ * them later doesn't pay the construction cost. Panels are built one
+ * at a time, only when there's enough of the current frame left and
+ * not while the user is interacting with the window.
+ */
+
+enum {
+  FINISHED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+enum {
+  PROP_0,
+  PROP_WINDOW,
+  PROP_STACK,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+struct _MsPanelPrewarmer {
+  GObject             parent;
+
+  GtkWidget          *window; /* unowned */
+  AdwViewStack       *stack;  /* unowned */
+  GtkEventController *input_controller;
+
+  GQueue              names;
+  guint               prewarm_id;
+  gint64              last_input;
+};
+
+G_DEFINE_TYPE (MsPanelPrewarmer, ms_panel_prewarmer, G_TYPE_OBJECT)
+
+
+static gboolean on_prewarm (gpointer user_data);
+
+
+static void
+schedule_prewarm (MsPanelPrewarmer *self, gint64 delay_us)
+{
+  g_clear_handle_id (&self->prewarm_id, g_source_remove);
+
+  if (g_queue_is_empty (&self->names))
+    return;
+
+  if (delay_us <= 0) {
+    self->prewarm_id = g_idle_add_full (G_PRIORITY_LOW, on_prewarm, self, NULL);
+  } else {
+    self->prewarm_id = g_timeout_add_full (G_PRIORITY_LOW,
+                                           (delay_us + 999) / 1000,
+                                           on_prewarm,
+                                           self,
+                                           NULL);
+  }
+  g_source_set_name_by_id (self->prewarm_id, "[ms] prewarm panels");
+}
+
+
+static MsPanel *
+get_placeholder (MsPanelPrewarmer *self, const char *name)
+{
+  GtkWidget *child = adw_view_stack_get_child_by_name (self->stack, name);
+
+  if (!MS_IS_PANEL (child) || !ms_panel_factory_has_panel (name))
+    return NULL;
+
+  /* Already built */
+  if (adw_bin_get_child (ADW_BIN (child)))
+    return NULL;
+
+  return MS_PANEL (child);
+}
+
+
+static gboolean
+on_prewarm (gpointer user_data)
+{
+  MsPanelPrewarmer *self = MS_PANEL_PREWARMER (user_data);
+  g_autofree char *name = NULL;
+  GdkFrameClock *frame_clock;
+  gint64 now, since_frame, interval = 0, budget, elapsed = 0;
+  MsPanel *placeholder;
+
+  self->prewarm_id = 0;
+
+  frame_clock = gtk_widget_get_frame_clock (self->window);
+  if (frame_clock == NULL) {
+    g_debug ("Window not realized, not prewarming");
+    ms_panel_prewarmer_stop (self);
+    return G_SOURCE_REMOVE;
+  }
+
+  now = g_get_monotonic_time ();
+  if (now - self->last_input < INPUT_QUIET_US) {
+    schedule_prewarm (self, INPUT_QUIET_US - (now - self->last_input));
+    return G_SOURCE_REMOVE;
+  }
+
+  gdk_frame_clock_get_refresh_info (frame_clock,
+                                    gdk_frame_clock_get_frame_time (frame_clock),
+                                    &interval,
+                                    NULL);
+  if (interval <= 0)
+    interval = DEFAULT_REFRESH_INTERVAL_US;
+  /* Leave the other half of the frame for layout and rendering */
+  budget = interval / 2;
+
+  /* If a frame is in flight and not enough of it is left wait for the next one */
+  since_frame = now - gdk_frame_clock_get_frame_time (frame_clock);
+  if (since_frame < interval && interval - since_frame < budget) {
+    schedule_prewarm (self, interval - since_frame);
+    return G_SOURCE_REMOVE;
+  }
+
+  name = g_queue_pop_head (&self->names);
+  placeholder = get_placeholder (self, name);
+  if (placeholder) {
+    ms_panel_factory_ensure (name, placeholder);
+
+    elapsed = g_get_monotonic_time () - now;
+    g_debug ("Prewarmed panel '%s' in %" G_GINT64_FORMAT "µs", name, elapsed);
+  }
+
+  if (g_queue_is_empty (&self->names)) {
+    g_signal_emit (self, signals[FINISHED], 0);
+    return G_SOURCE_REMOVE;
+  }
+
+  /* Give the next frame a chance before building the next panel */
+  schedule_prewarm (self, elapsed > budget ? interval : 0);
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_input_event (MsPanelPrewarmer *self, GdkEvent *event, GtkEventControllerLegacy *controller)
+{
+  switch (gdk_event_get_event_type (event)) {
+  case GDK_BUTTON_PRESS:
+  case GDK_KEY_PRESS:
+  case GDK_SCROLL:
+  case GDK_TOUCH_BEGIN:
+  case GDK_TOUCH_UPDATE:
+  case GDK_TOUCHPAD_SWIPE:
+  case GDK_TOUCHPAD_PINCH:
+    self->last_input = g_get_monotonic_time ();
+    break;
+  default:
+    break;
+  }
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
+static void
+ms_panel_prewarmer_set_property (GObject      *object,
+                                 guint         property_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  MsPanelPrewarmer *self = MS_PANEL_PREWARMER (object);
+
+  switch (property_id) {
+  case PROP_WINDOW:
+    self->window = g_value_get_object (value);
+    break;
+  case PROP_STACK:
+    self->stack = g_value_get_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_panel_prewarmer_get_property (GObject    *object,
+                                 guint       property_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  MsPanelPrewarmer *self = MS_PANEL_PREWARMER (object);
+
+  switch (property_id) {
+  case PROP_WINDOW:
+    g_value_set_object (value, self->window);
+    break;
+  case PROP_STACK:
+    g_value_set_object (value, self->stack);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_panel_prewarmer_constructed (GObject *object)
+{
+  MsPanelPrewarmer *self = MS_PANEL_PREWARMER (object);
+
+  G_OBJECT_CLASS (ms_panel_prewarmer_parent_class)->constructed (object);
+
+  self->input_controller = gtk_event_controller_legacy_new ();
+  gtk_event_controller_set_propagation_phase (self->input_controller, GTK_PHASE_CAPTURE);
+  g_signal_connect_object (self->input_controller,
+                           "event",
+                           G_CALLBACK (on_input_event),
+                           self,
+                           G_CONNECT_SWAPPED);
+  gtk_widget_add_controller (self->window, self->input_controller);
+}
+
+
+static void
+ms_panel_prewarmer_dispose (GObject *object)
+{
+  MsPanelPrewarmer *self = MS_PANEL_PREWARMER (object);
+
+  ms_panel_prewarmer_stop (self);
+
+  if (self->input_controller) {
+    gtk_widget_remove_controller (self->window, self->input_controller);
+    self->input_controller = NULL;
+  }
+
+  G_OBJECT_CLASS (ms_panel_prewarmer_parent_class)->dispose (object);
+}
+
+
+static void
+ms_panel_prewarmer_class_init (MsPanelPrewarmerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = ms_panel_prewarmer_get_property;
+  object_class->set_property = ms_panel_prewarmer_set_property;
+  object_class->constructed = ms_panel_prewarmer_constructed;
+  object_class->dispose = ms_panel_prewarmer_dispose;
+
+  /**
+   * MsPanelPrewarmer:window:
+   *
+   * The window whose frame clock and input is used for scheduling
+   */
+  props[PROP_WINDOW] =
+    g_param_spec_object ("window", "", "",
+                         GTK_TYPE_WIDGET,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * MsPanelPrewarmer:stack:
+   *
+   * The view stack holding the panel placeholders
+   */
+  props[PROP_STACK] =
+    g_param_spec_object ("stack", "", "",
+                         ADW_TYPE_VIEW_STACK,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * MsPanelPrewarmer::finished:
+   *
+   * All queued panels were built.
+   */
+  signals[FINISHED] = g_signal_new ("finished",
+                                    G_TYPE_FROM_CLASS (klass),
+                                    G_SIGNAL_RUN_LAST,
+                                    0, NULL, NULL, NULL,
+                                    G_TYPE_NONE,
+                                    0);
+}
+
+
+static void
+ms_panel_prewarmer_init (MsPanelPrewarmer *self)
+{
+  g_queue_init (&self->names);
+}
+
+
+MsPanelPrewarmer *
+ms_panel_prewarmer_new (GtkWidget *window, AdwViewStack *stack)
+{
+  return g_object_new (MS_TYPE_PANEL_PREWARMER,
+                       "window", window,
+                       "stack", stack,
+                       NULL);
+}
+
+/**
+ * ms_panel_prewarmer_start:
+ * @self: The prewarmer
+ * @names: The panels to build, most likely to be used first
+ *
+ * Queue the given panels for building. Panels that are unknown or
+ * already built are skipped. `MsPanelPrewarmer::finished` is emitted
+ * once all of them are built.
+ */
+void
+ms_panel_prewarmer_start (MsPanelPrewarmer *self, const char * const *names)
+{
+  g_return_if_fail (MS_IS_PANEL_PREWARMER (self));
+
+  for (guint i = 0; names && names[i]; i++) {
+    if (!get_placeholder (self, names[i]))
+      continue;
+
+    if (g_queue_find_custom (&self->names, names[i], (GCompareFunc) g_strcmp0))
+      continue;
+
+    g_queue_push_tail (&self->names, g_strdup (names[i]));
+  }
+
+  if (g_queue_is_empty (&self->names)) {
+    g_signal_emit (self, signals[FINISHED], 0);
+    return;
+  }
+
+  if (self->prewarm_id == 0)
+    schedule_prewarm (self, 0);
+}
+
+/**
+ * ms_panel_prewarmer_stop:
+ * @self: The prewarmer
+ *
+ * Drop all queued panels.
+ */
+void
+ms_panel_prewarmer_stop (MsPanelPrewarmer *self)
+{
+  g_return_if_fail (MS_IS_PANEL_PREWARMER (self));
+
+  g_clear_handle_id (&self->prewarm_id, g_source_remove);
+  g_queue_clear_full (&self->names, g_free);
+}
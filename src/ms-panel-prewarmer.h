@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <adwaita.h>
+
+G_BEGIN_DECLS
+
+#define MS_TYPE_PANEL_PREWARMER (ms_panel_prewarmer_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsPanelPrewarmer, ms_panel_prewarmer, MS, PANEL_PREWARMER, GObject)
+
+MsPanelPrewarmer *ms_panel_prewarmer_new   (GtkWidget          *window,
+                                            AdwViewStack       *stack);
+void              ms_panel_prewarmer_start (MsPanelPrewarmer   *self,
+                                            const char * const *names);
+void              ms_panel_prewarmer_stop  (MsPanelPrewarmer   *self);
+
+G_END_DECLS
@@ -13,6 +13,7 @@ enum {
   PROP_0,
   PROP_KEYWORDS,
   PROP_ENABLED,
+  PROP_READY,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -22,10 +23,16 @@ static GParamSpec *props[PROP_LAST_PROP];
  *
  * Base class for standard panels. Panel implementations need to derive
  * from this class.
+ *
+ * Panels that need to query services (e.g. via DBus) shouldn't block
+ * in their constructor. They should instead mark themselves as not
+ * `ready`, show what they can right away and fill in the rest once
+ * the async initialization finished.
  */
 typedef struct {
   GtkStringList *keywords;
   gboolean       enabled;
+  gboolean       ready;
 } MsPanelPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MsPanel, ms_panel, ADW_TYPE_BIN)
@@ -46,6 +53,9 @@ ms_panel_set_property (GObject      *object,
   case PROP_ENABLED:
     ms_panel_set_enabled (self, g_value_get_boolean (value));
     break;
+  case PROP_READY:
+    ms_panel_set_ready (self, g_value_get_boolean (value));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -69,6 +79,9 @@ ms_panel_get_property (GObject    *object,
   case PROP_ENABLED:
     g_value_set_boolean (value, ms_panel_get_enabled (self));
     break;
+  case PROP_READY:
+    g_value_set_boolean (value, ms_panel_get_ready (self));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -115,6 +128,15 @@ ms_panel_class_init (MsPanelClass *klass)
     g_param_spec_boolean ("enabled", "", "",
                           TRUE,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * MsPanel:ready:
+   *
+   * Whether the panel finished its asynchronous initialization
+   */
+  props[PROP_READY] =
+    g_param_spec_boolean ("ready", "", "",
+                          TRUE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
@@ -126,6 +148,7 @@ ms_panel_init (MsPanel *self)
   MsPanelPrivate *priv = ms_panel_get_instance_private (self);
 
   priv->enabled = TRUE;
+  priv->ready = TRUE;
 }
 
 
@@ -171,8 +194,15 @@ ms_panel_handle_options (MsPanel *self, GVariant *params)
 
   klass = MS_PANEL_GET_CLASS (self);
 
-  if (klass->handle_options == NULL)
+  if (klass->handle_options == NULL) {
+    GtkWidget *child = adw_bin_get_child (ADW_BIN (self));
+
+    /* Placeholder panels pass options on to the actual panel */
+    if (MS_IS_PANEL (child))
+      return ms_panel_handle_options (MS_PANEL (child), params);
+
     return TRUE;
+  }
 
   return klass->handle_options (self, params);
 }
@@ -202,3 +232,29 @@ ms_panel_get_enabled (MsPanel *self)
 
   return priv->enabled;
 }
+
+
+void
+ms_panel_set_ready (MsPanel *self, gboolean ready)
+{
+  MsPanelPrivate *priv = ms_panel_get_instance_private (self);
+
+  g_return_if_fail (MS_IS_PANEL (self));
+
+  if (priv->ready == ready)
+    return;
+
+  priv->ready = ready;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_READY]);
+}
+
+
+gboolean
+ms_panel_get_ready (MsPanel *self)
+{
+  MsPanelPrivate *priv = ms_panel_get_instance_private (self);
+
+  g_return_val_if_fail (MS_IS_PANEL (self), TRUE);
+
+  return priv->ready;
+}
@@ -33,6 +33,8 @@ GtkStringList *ms_panel_get_keywords (MsPanel *self);
 void           ms_panel_set_keywords (MsPanel *self, GtkStringList *keywords);
 gboolean       ms_panel_get_enabled (MsPanel *self);
 void           ms_panel_set_enabled (MsPanel *self, gboolean enabled);
+gboolean       ms_panel_get_ready (MsPanel *self);
+void           ms_panel_set_ready (MsPanel *self, gboolean ready);
 gboolean       ms_panel_handle_options (MsPanel *self, GVariant *params);
 
 G_END_DECLS
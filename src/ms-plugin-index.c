@@ -0,0 +1,518 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-plugin-index"
+
+#include "mobile-settings-config.h"
+
+#include "ms-plugin-index.h"
+
+#include <errno.h>
+#include <locale.h>
+
+#define PHOSH_PLUGIN_PREFIX ""
+#define PHOSH_PLUGIN_SUFFIX ".plugin"
+
+#define CACHE_DIR   "phosh-mobile-settings"
+#define CACHE_GROUP "Cache"
+
+/**
+ * MsPluginIndex:
+ *
+ * The metadata of the installed phosh plugins. Parsing the plugin
+ * files happens once for all plugin lists on a worker thread. The
+ * result is persisted in `$XDG_CACHE_HOME` keyed by the plugin
+ * directory's modification time and the UI language so later runs
+ * only need to load a single key file. The index gets rebuilt when
+ * the plugin directory changes.
+ */
+
+enum {
+  PROP_0,
+  PROP_LOADED,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _MsPluginIndex {
+  GObject       parent;
+
+  gboolean      loaded;
+  GPtrArray    *plugins;
+
+  GFileMonitor *monitor;
+  GCancellable *cancel;
+};
+G_DEFINE_TYPE (MsPluginIndex, ms_plugin_index, G_TYPE_OBJECT)
+
+
+static void
+ms_plugin_info_free (MsPluginInfo *info)
+{
+  g_free (info->id);
+  g_free (info->filename);
+  g_free (info->title);
+  g_free (info->description);
+  g_free (info->icon_name);
+  g_strfreev (info->types);
+  g_free (info);
+}
+
+
+static GPtrArray *
+plugins_new (void)
+{
+  return g_ptr_array_new_with_free_func ((GDestroyNotify) ms_plugin_info_free);
+}
+
+
+static char *
+get_cache_path (const char *ui_lang)
+{
+  g_autofree char *filename = g_strdup_printf ("plugins-%s.ini", ui_lang);
+
+  g_strdelimit (filename, G_DIR_SEPARATOR_S, '_');
+  return g_build_filename (g_get_user_cache_dir (), CACHE_DIR, filename, NULL);
+}
+
+
+static char *
+get_stamp (void)
+{
+  g_autoptr (GFile) dir = g_file_new_for_path (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR);
+  g_autoptr (GFileInfo) info = NULL;
+  g_autoptr (GDateTime) mtime = NULL;
+
+  info = g_file_query_info (dir,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL,
+                            NULL);
+  if (info == NULL)
+    return NULL;
+
+  mtime = g_file_info_get_modification_date_time (info);
+  if (mtime == NULL)
+    return NULL;
+
+  return g_strdup_printf (PACKAGE_VERSION "-%" G_GINT64_FORMAT, g_date_time_to_unix_usec (mtime));
+}
+
+
+static MsPluginInfo *
+load_plugin (const char *path)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr (GError) err = NULL;
+  g_autofree char *id = NULL;
+  g_autofree char *plugin_path = NULL;
+  g_autofree char *prefs_path = NULL;
+  MsPluginInfo *info;
+
+  if (g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &err) == FALSE) {
+    g_warning ("Failed to load plugin info '%s': %s", path, err->message);
+    return NULL;
+  }
+
+  id = g_key_file_get_string (keyfile, "Plugin", "Id", NULL);
+  if (id == NULL)
+    return NULL;
+
+  plugin_path = g_key_file_get_string (keyfile, "Plugin", "Plugin", NULL);
+  if (plugin_path == NULL)
+    return NULL;
+
+  if (g_file_test (plugin_path, G_FILE_TEST_EXISTS) == FALSE) {
+    g_warning ("Plugin at %s does not exist", plugin_path);
+    return NULL;
+  }
+
+  if (g_key_file_get_boolean (keyfile, "Plugin", "NoDisplay", NULL))
+    return NULL;
+
+  info = g_new0 (MsPluginInfo, 1);
+  info->id = g_steal_pointer (&id);
+  info->filename = g_strdup (path);
+  info->title = g_key_file_get_locale_string (keyfile, "Plugin", "Name", NULL, NULL);
+  info->description = g_key_file_get_locale_string (keyfile, "Plugin", "Comment", NULL, NULL);
+  info->icon_name = g_key_file_get_string (keyfile, "Plugin", "Icon", NULL);
+  info->types = g_key_file_get_string_list (keyfile, "Plugin", "Types", NULL, NULL);
+  prefs_path = g_key_file_get_string (keyfile, "Prefs", "Plugin", NULL);
+  info->has_prefs = !!prefs_path;
+
+  if (info->types == NULL)
+    g_warning ("Plugin '%s' has no type. Please fix", info->id);
+
+  if (info->icon_name == NULL)
+    g_debug ("Failed to get icon for %s plugin", info->id);
+
+  return info;
+}
+
+
+static GPtrArray *
+scan_plugins (void)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GDir) dir = g_dir_open (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR, 0, &err);
+  g_autoptr (GPtrArray) plugins = plugins_new ();
+  const char *filename;
+
+  if (dir == NULL) {
+    g_warning ("Failed to read phosh plugins from " MOBILE_SETTINGS_PHOSH_PLUGINS_DIR ": %s",
+               err->message);
+    return g_steal_pointer (&plugins);
+  }
+
+  while ((filename = g_dir_read_name (dir))) {
+    g_autofree char *path = NULL;
+    MsPluginInfo *info;
+
+    if (!g_str_has_prefix (filename, PHOSH_PLUGIN_PREFIX) ||
+        !g_str_has_suffix (filename, PHOSH_PLUGIN_SUFFIX))
+      continue;
+
+    path = g_build_filename (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR, filename, NULL);
+    info = load_plugin (path);
+    if (info == NULL)
+      continue;
+
+    g_debug ("Found plugin %s, name %s, prefs: %d", filename, info->id, info->has_prefs);
+    g_ptr_array_add (plugins, info);
+  }
+
+  return g_steal_pointer (&plugins);
+}
+
+
+static GPtrArray *
+load_cache (const char *path, const char *stamp)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr (GPtrArray) plugins = NULL;
+  g_autofree char *cache_stamp = NULL;
+  g_auto (GStrv) groups = NULL;
+
+  if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, NULL))
+    return NULL;
+
+  cache_stamp = g_key_file_get_string (keyfile, CACHE_GROUP, "Stamp", NULL);
+  if (g_strcmp0 (cache_stamp, stamp) != 0) {
+    g_debug ("Plugin cache %s is stale", path);
+    return NULL;
+  }
+
+  plugins = plugins_new ();
+  groups = g_key_file_get_groups (keyfile, NULL);
+  for (int i = 0; groups[i]; i++) {
+    MsPluginInfo *info;
+
+    if (g_str_equal (groups[i], CACHE_GROUP))
+      continue;
+
+    info = g_new0 (MsPluginInfo, 1);
+    info->id = g_key_file_get_string (keyfile, groups[i], "Id", NULL);
+    info->filename = g_strdup (groups[i]);
+    info->title = g_key_file_get_string (keyfile, groups[i], "Name", NULL);
+    info->description = g_key_file_get_string (keyfile, groups[i], "Comment", NULL);
+    info->icon_name = g_key_file_get_string (keyfile, groups[i], "Icon", NULL);
+    info->types = g_key_file_get_string_list (keyfile, groups[i], "Types", NULL, NULL);
+    info->has_prefs = g_key_file_get_boolean (keyfile, groups[i], "HasPrefs", NULL);
+    g_ptr_array_add (plugins, info);
+  }
+
+  return g_steal_pointer (&plugins);
+}
+
+
+static void
+set_optional_string (GKeyFile *keyfile, const char *group, const char *key, const char *value)
+{
+  if (value)
+    g_key_file_set_string (keyfile, group, key, value);
+}
+
+
+static void
+save_cache (const char *path, const char *stamp, GPtrArray *plugins)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autoptr (GError) err = NULL;
+
+  g_key_file_set_string (keyfile, CACHE_GROUP, "Stamp", stamp);
+
+  for (guint i = 0; i < plugins->len; i++) {
+    MsPluginInfo *info = g_ptr_array_index (plugins, i);
+
+    g_key_file_set_string (keyfile, info->filename, "Id", info->id);
+    set_optional_string (keyfile, info->filename, "Name", info->title);
+    set_optional_string (keyfile, info->filename, "Comment", info->description);
+    set_optional_string (keyfile, info->filename, "Icon", info->icon_name);
+    if (info->types) {
+      g_key_file_set_string_list (keyfile, info->filename, "Types",
+                                  (const char * const *) info->types,
+                                  g_strv_length (info->types));
+    }
+    g_key_file_set_boolean (keyfile, info->filename, "HasPrefs", info->has_prefs);
+  }
+
+  if (g_mkdir_with_parents (dir, 0700) != 0) {
+    g_debug ("Failed to create %s: %s", dir, g_strerror (errno));
+    return;
+  }
+
+  if (!g_key_file_save_to_file (keyfile, path, &err))
+    g_debug ("Failed to save plugin cache: %s", err->message);
+}
+
+
+static void
+load_plugins_in_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  const char *ui_lang = task_data;
+  g_autofree char *path = get_cache_path (ui_lang);
+  g_autofree char *stamp = get_stamp ();
+  g_autoptr (GPtrArray) plugins = NULL;
+
+  if (stamp)
+    plugins = load_cache (path, stamp);
+
+  if (plugins == NULL) {
+    plugins = scan_plugins ();
+
+    if (stamp)
+      save_cache (path, stamp, plugins);
+  }
+
+  g_task_return_pointer (task, g_steal_pointer (&plugins), (GDestroyNotify) g_ptr_array_unref);
+}
+
+
+static void
+on_plugins_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  MsPluginIndex *self;
+  g_autoptr (GPtrArray) plugins = NULL;
+  g_autoptr (GError) err = NULL;
+
+  plugins = g_task_propagate_pointer (G_TASK (res), &err);
+  if (plugins == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to load plugins: %s", err->message);
+    return;
+  }
+
+  self = MS_PLUGIN_INDEX (source_object);
+
+  g_clear_pointer (&self->plugins, g_ptr_array_unref);
+  self->plugins = g_steal_pointer (&plugins);
+  g_debug ("Indexed %u plugins", self->plugins->len);
+
+  if (!self->loaded) {
+    self->loaded = TRUE;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOADED]);
+  }
+  g_signal_emit (self, signals[CHANGED], 0);
+}
+
+
+static void
+load_plugins (MsPluginIndex *self)
+{
+  g_autoptr (GTask) task = NULL;
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  self->cancel = g_cancellable_new ();
+
+  task = g_task_new (self, self->cancel, on_plugins_loaded, NULL);
+  g_task_set_source_tag (task, load_plugins);
+  g_task_set_task_data (task, g_strdup (setlocale (LC_MESSAGES, NULL)), g_free);
+  g_task_run_in_thread (task, load_plugins_in_thread);
+}
+
+
+static void
+on_plugins_dir_changed (MsPluginIndex     *self,
+                        GFile             *file,
+                        GFile             *other_file,
+                        GFileMonitorEvent  event_type)
+{
+  switch (event_type) {
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+  case G_FILE_MONITOR_EVENT_DELETED:
+  case G_FILE_MONITOR_EVENT_CREATED:
+  case G_FILE_MONITOR_EVENT_MOVED_IN:
+  case G_FILE_MONITOR_EVENT_MOVED_OUT:
+  case G_FILE_MONITOR_EVENT_RENAMED:
+    g_debug ("Plugin directory changed, reloading");
+    load_plugins (self);
+    break;
+  case G_FILE_MONITOR_EVENT_CHANGED:
+  case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+  case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
+  case G_FILE_MONITOR_EVENT_UNMOUNTED:
+  case G_FILE_MONITOR_EVENT_MOVED:
+  default:
+    break;
+  }
+}
+
+
+static void
+ms_plugin_index_get_property (GObject    *object,
+                              guint       property_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  MsPluginIndex *self = MS_PLUGIN_INDEX (object);
+
+  switch (property_id) {
+  case PROP_LOADED:
+    g_value_set_boolean (value, self->loaded);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+ms_plugin_index_dispose (GObject *object)
+{
+  MsPluginIndex *self = MS_PLUGIN_INDEX (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (ms_plugin_index_parent_class)->dispose (object);
+}
+
+
+static void
+ms_plugin_index_finalize (GObject *object)
+{
+  MsPluginIndex *self = MS_PLUGIN_INDEX (object);
+
+  g_clear_pointer (&self->plugins, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (ms_plugin_index_parent_class)->finalize (object);
+}
+
+
+static void
+ms_plugin_index_class_init (MsPluginIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = ms_plugin_index_get_property;
+  object_class->dispose = ms_plugin_index_dispose;
+  object_class->finalize = ms_plugin_index_finalize;
+
+  /**
+   * MsPluginIndex:loaded:
+   *
+   * Whether the installed plugins were indexed
+   */
+  props[PROP_LOADED] =
+    g_param_spec_boolean ("loaded", "", "",
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * MsPluginIndex::changed:
+   *
+   * The set of installed plugins was (re)loaded.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   0);
+}
+
+
+static void
+ms_plugin_index_init (MsPluginIndex *self)
+{
+  g_autoptr (GFile) dir = g_file_new_for_path (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR);
+  g_autoptr (GError) err = NULL;
+
+  self->plugins = plugins_new ();
+
+  self->monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_NONE, NULL, &err);
+  if (self->monitor) {
+    g_signal_connect_object (self->monitor,
+                             "changed",
+                             G_CALLBACK (on_plugins_dir_changed),
+                             self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    g_debug ("Failed to monitor " MOBILE_SETTINGS_PHOSH_PLUGINS_DIR ": %s", err->message);
+  }
+
+  load_plugins (self);
+}
+
+/**
+ * ms_plugin_index_get_default:
+ *
+ * Get the application wide plugin index. It must only be used from
+ * the main thread.
+ *
+ * Returns:(transfer none): The plugin index
+ */
+MsPluginIndex *
+ms_plugin_index_get_default (void)
+{
+  static MsPluginIndex *instance;
+
+  if (instance == NULL)
+    instance = g_object_new (MS_TYPE_PLUGIN_INDEX, NULL);
+
+  return instance;
+}
+
+
+gboolean
+ms_plugin_index_get_loaded (MsPluginIndex *self)
+{
+  g_return_val_if_fail (MS_IS_PLUGIN_INDEX (self), FALSE);
+
+  return self->loaded;
+}
+
+/**
+ * ms_plugin_index_get_plugins:
+ * @self: The plugin index
+ *
+ * Get the installed plugins. The result is replaced when the index
+ * changes so don't hold on to it.
+ *
+ * Returns:(transfer none)(element-type MsPluginInfo): The plugins
+ */
+GPtrArray *
+ms_plugin_index_get_plugins (MsPluginIndex *self)
+{
+  g_return_val_if_fail (MS_IS_PLUGIN_INDEX (self), NULL);
+
+  return self->plugins;
+}
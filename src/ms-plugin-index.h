@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * MsPluginInfo:
+ * @id: The plugin's id
+ * @filename: The path of the `.plugin` file
+ * @title: The plugin's name in the current UI language
+ * @description: The plugin's description in the current UI language
+ * @icon_name: The plugin's icon name
+ * @types: The plugin's types
+ * @has_prefs: Whether the plugin has preferences
+ *
+ * The metadata of an installed phosh plugin.
+ */
+typedef struct {
+  char     *id;
+  char     *filename;
+  char     *title;
+  char     *description;
+  char     *icon_name;
+  GStrv     types;
+  gboolean  has_prefs;
+} MsPluginInfo;
+
+#define MS_TYPE_PLUGIN_INDEX (ms_plugin_index_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsPluginIndex, ms_plugin_index, MS, PLUGIN_INDEX, GObject)
+
+MsPluginIndex *ms_plugin_index_get_default (void);
+gboolean       ms_plugin_index_get_loaded  (MsPluginIndex *self);
+GPtrArray     *ms_plugin_index_get_plugins (MsPluginIndex *self);
+
+G_END_DECLS
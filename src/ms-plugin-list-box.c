@@ -10,14 +10,13 @@
 
 #include "mobile-settings-config.h"
 
+#include "ms-plugin-index.h"
 #include "ms-plugin-list-box.h"
 #include "ms-plugin-row.h"
+#include "ms-trace.h"
 
 #define PHOSH_PLUGINS_SCHEMA_ID "sm.puri.phosh.plugins"
 
-#define PHOSH_PLUGIN_PREFIX ""
-#define PHOSH_PLUGIN_SUFFIX ".plugin"
-
 /**
  * MsPluginList_box:
  *
@@ -41,13 +40,14 @@ struct _MsPluginListBox {
   GtkWidget            *list_box;
   GListStore           *store;
 
-  MsPluginRow          *selected_row;
   AdwPreferencesDialog *prefs_dialog;
 
   GSimpleActionGroup   *action_group;
 
   char                 *plugin_type;
   char                 *prefs_extension_point;
+  /* Prefs to open once the plugin index is loaded */
+  char                 *pending_prefs;
 };
 G_DEFINE_TYPE (MsPluginListBox, ms_plugin_list_box, ADW_TYPE_BIN)
 
@@ -138,6 +138,7 @@ static void
 save_plugin_store (MsPluginListBox *self)
 {
   g_auto (GStrv) ret = NULL;
+  g_auto (GStrv) current = NULL;
   g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
 
   guint n_plugins = g_list_model_get_n_items (G_LIST_MODEL (self->store));
@@ -158,6 +159,11 @@ save_plugin_store (MsPluginListBox *self)
     }
   }
   ret = g_strv_builder_end (builder);
+
+  current = g_settings_get_strv (self->settings, self->settings_key);
+  if (g_strv_equal ((const char * const *)current, (const char * const *)ret))
+    return;
+
   g_settings_set_strv (self->settings, self->settings_key, (const char * const *)ret);
 }
 
@@ -183,36 +189,32 @@ update_enabled_move_actions (MsPluginListBox *self)
 }
 
 
-static void
-row_move_selected (MsPluginListBox *self, gboolean down)
-{
-  gint selected_idx, dest_idx;
-  MsPluginRow *plugin_row = NULL;
-
-  selected_idx = gtk_list_box_row_get_index (GTK_LIST_BOX_ROW (self->selected_row));
-  dest_idx = down ? selected_idx + 1 : selected_idx - 1;
-
-  plugin_row = g_list_model_get_item (G_LIST_MODEL (self->store), selected_idx);
-  g_list_store_remove (self->store, selected_idx);
-  g_list_store_insert (self->store, dest_idx, plugin_row);
-
-  update_enabled_move_actions (self);
-}
-
-
 static void
 on_row_moved (MsPluginListBox *self, MsPluginRow *dest_row, MsPluginRow *row)
 {
+  GListModel *model = G_LIST_MODEL (self->store);
   gint source_idx = gtk_list_box_row_get_index (GTK_LIST_BOX_ROW (row));
   gint dest_idx = gtk_list_box_row_get_index (GTK_LIST_BOX_ROW (dest_row));
-  gboolean down;
+  g_autoptr (GPtrArray) rows = g_ptr_array_new_with_free_func (g_object_unref);
+  guint first, last;
+
+  if (source_idx == dest_idx || source_idx < 0 || dest_idx < 0)
+    return;
+
+  /* Rotate the rows between source and destination in one go */
+  first = MIN (source_idx, dest_idx);
+  last = MAX (source_idx, dest_idx);
+  for (guint i = first; i <= last; i++)
+    g_ptr_array_add (rows, g_list_model_get_item (model, i));
 
-  self->selected_row = row;
+  if (source_idx < dest_idx)
+    g_ptr_array_add (rows, g_ptr_array_steal_index (rows, 0));
+  else
+    g_ptr_array_insert (rows, 0, g_ptr_array_steal_index (rows, rows->len - 1));
 
-  down = (source_idx - dest_idx) < 0;
-  for (int i = 0; i < ABS (source_idx - dest_idx); i++)
-    row_move_selected (self, down);
+  g_list_store_splice (self->store, first, rows->len, rows->pdata, rows->len);
 
+  update_enabled_move_actions (self);
   save_plugin_store (self);
 }
 
@@ -224,127 +226,115 @@ on_plugin_activated (MsPluginListBox *self, GParamSpec *pspec, MsPluginRow *row)
 }
 
 
+static int
+compare_plugin_rank (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  GHashTable *ranks = user_data;
+  const char *name_a = ms_plugin_row_get_name (MS_PLUGIN_ROW ((gpointer) a));
+  const char *name_b = ms_plugin_row_get_name (MS_PLUGIN_ROW ((gpointer) b));
+  gpointer rank_a, rank_b;
+  gboolean has_a, has_b;
+
+  has_a = g_hash_table_lookup_extended (ranks, name_a, NULL, &rank_a);
+  has_b = g_hash_table_lookup_extended (ranks, name_b, NULL, &rank_b);
+
+  /* Plugins unknown to phosh go last */
+  if (has_a != has_b)
+    return has_a ? -1 : 1;
+
+  if (!has_a)
+    return g_strcmp0 (name_a, name_b);
+
+  if (GPOINTER_TO_UINT (rank_a) == GPOINTER_TO_UINT (rank_b))
+    return 0;
+
+  return GPOINTER_TO_UINT (rank_a) < GPOINTER_TO_UINT (rank_b) ? -1 : 1;
+}
+
 /**
- * sort_plugins_store:
+ * get_plugin_ranks:
  *
- * Update the plugins store to match the order in phosh
+ * Map the enabled plugins to their position in phosh's order
  */
-static void
-sort_plugins_store (MsPluginListBox *self)
+static GHashTable *
+get_plugin_ranks (GStrv plugins_order)
 {
-  g_auto (GStrv) plugins_order = g_settings_get_strv (self->settings, self->settings_key);
+  GHashTable *ranks = g_hash_table_new (g_str_hash, g_str_equal);
 
-  for (guint i = 0; i < g_strv_length (plugins_order); i++) {
-    for (guint j = 0; j < g_list_model_get_n_items (G_LIST_MODEL (self->store)); j++) {
-      g_autoptr (MsPluginRow) plugin_row = g_list_model_get_item (G_LIST_MODEL (self->store), j);
-
-      if (g_strcmp0 (plugins_order[i], ms_plugin_row_get_name (plugin_row)) == 0) {
-        g_list_store_remove (self->store, j);
-        g_list_store_insert (self->store, i, plugin_row);
-        break;
-      }
-    }
+  for (guint i = 0; plugins_order[i]; i++) {
+    if (!g_hash_table_contains (ranks, plugins_order[i]))
+      g_hash_table_insert (ranks, plugins_order[i], GUINT_TO_POINTER (i));
   }
+
+  return ranks;
 }
 
 
 static void
-ms_plugin_list_box_scan_phosh_plugins (MsPluginListBox *self)
+ms_plugin_list_box_populate (MsPluginListBox *self)
 {
-  g_autoptr (GError) err = NULL;
-  g_autoptr (GDir) dir = g_dir_open (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR, 0, &err);
+  MsPluginIndex *index = ms_plugin_index_get_default ();
+  GPtrArray *plugins = ms_plugin_index_get_plugins (index);
+  /* Rows are floating, the store's bind model function sinks them */
+  g_autoptr (GPtrArray) rows = g_ptr_array_new ();
   g_auto (GStrv) enabled_plugins = NULL;
-  const char *filename;
+  g_autoptr (GHashTable) ranks = NULL;
+  gint64 begin;
 
-  if (dir == NULL) {
-    g_warning ("Failed to read phosh plugins from " MOBILE_SETTINGS_PHOSH_PLUGINS_DIR ": %s",
-               err->message);
+  if (self->settings_key == NULL)
     return;
-  }
+
+  begin = ms_trace_begin ();
 
   enabled_plugins = g_settings_get_strv (self->settings, self->settings_key);
-  while ((filename = g_dir_read_name (dir))) {
+  ranks = get_plugin_ranks (enabled_plugins);
+  for (guint i = 0; i < plugins->len; i++) {
+    MsPluginInfo *info = g_ptr_array_index (plugins, i);
     GtkWidget *row;
     gboolean enabled;
-    g_autofree char *name = NULL;
-    g_autofree char *title = NULL;
-    g_autofree char *description = NULL;
-    g_autofree char *path = NULL;
-    g_autofree char *plugin_path = NULL;
-    g_autofree char *prefs_path = NULL;
-    g_autoptr (GError) error = NULL;
-    g_autoptr (GKeyFile) keyfile = g_key_file_new ();
-    g_auto (GStrv) types = NULL;
-    g_autofree char *icon_name = NULL;
-
-    if (!g_str_has_prefix (filename, PHOSH_PLUGIN_PREFIX) ||
-        !g_str_has_suffix (filename, PHOSH_PLUGIN_SUFFIX))
-      continue;
-
-    path = g_build_filename (MOBILE_SETTINGS_PHOSH_PLUGINS_DIR, filename, NULL);
-    if (g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &error) == FALSE) {
-      g_warning ("Failed to load plugin info '%s': %s", filename, error->message);
-      continue;
-    }
-
-    name = g_key_file_get_string (keyfile, "Plugin", "Id", NULL);
-    if (name == NULL)
-      continue;
-
-    plugin_path = g_key_file_get_string (keyfile, "Plugin", "Plugin", NULL);
-    if (plugin_path == NULL)
-      continue;
-
-    if (g_file_test (plugin_path, G_FILE_TEST_EXISTS) == FALSE) {
-      g_warning ("Plugin at %s does not exist", plugin_path);
-      continue;
-    }
-
-    prefs_path = g_key_file_get_string (keyfile, "Prefs", "Plugin", NULL);
-
-    title = g_key_file_get_locale_string (keyfile, "Plugin", "Name", NULL, NULL);
-    description = g_key_file_get_locale_string (keyfile, "Plugin", "Comment", NULL, NULL);
-    types = g_key_file_get_string_list (keyfile, "Plugin", "Types", NULL, NULL);
-    icon_name = g_key_file_get_string (keyfile, "Plugin", "Icon", NULL);
-
-    if (types == NULL)
-      g_warning ("Plugin '%s' has no type. Please fix", name);
-
-    if (icon_name == NULL)
-      g_debug ("Failed to get icon for %s plugin", name);
 
-    if (!g_strv_contains ((const char *const *)types, self->plugin_type))
+    if (info->types == NULL || !g_strv_contains ((const char *const *)info->types, self->plugin_type))
       continue;
 
-    if (g_key_file_get_boolean (keyfile, "Plugin", "NoDisplay", NULL))
-      continue;
-
-    enabled = g_strv_contains ((const char * const*)enabled_plugins, name);
-    g_debug ("Found plugin %s, name %s, enabled: %d, prefs: %d", filename, name, enabled,
-             !!prefs_path);
+    enabled = g_hash_table_contains (ranks, info->id);
+    g_debug ("Adding plugin %s, enabled: %d", info->id, enabled);
     row = g_object_new (MS_TYPE_PLUGIN_ROW,
-                        "plugin-name", name,
-                        "title", title,
-                        "subtitle", description,
+                        "plugin-name", info->id,
+                        "title", info->title,
+                        "subtitle", info->description,
                         "enabled", enabled,
-                        "has-prefs", !!prefs_path,
-                        "filename", path,
-                        "icon", icon_name,
+                        "has-prefs", info->has_prefs,
+                        "filename", info->filename,
+                        "icon", info->icon_name,
                         NULL);
     g_signal_connect_object (row,
                              "notify::enabled",
                              G_CALLBACK (on_plugin_activated),
                              self,
                              G_CONNECT_SWAPPED);
-
-    g_list_store_append (self->store, row);
-
     g_signal_connect_object (row, "move-row",
                              G_CALLBACK (on_row_moved), self,
                              G_CONNECT_SWAPPED);
+
+    g_ptr_array_add (rows, row);
   }
-  sort_plugins_store (self);
+
+  /* Sort upfront so the store only changes once */
+  g_ptr_array_sort_values_with_data (rows, compare_plugin_rank, ranks);
+  g_list_store_splice (self->store,
+                       0,
+                       g_list_model_get_n_items (G_LIST_MODEL (self->store)),
+                       rows->pdata,
+                       rows->len);
   update_enabled_move_actions (self);
+
+  ms_trace_end (begin, "plugin-list", self->settings_key);
+
+  if (self->pending_prefs && ms_plugin_index_get_loaded (index)) {
+    g_autofree char *name = g_steal_pointer (&self->pending_prefs);
+
+    ms_plugin_list_box_open_plugin_prefs (self, name);
+  }
 }
 
 
@@ -352,7 +342,7 @@ static void
 ms_plugin_list_box_set_settings_key (MsPluginListBox *self, const char *key)
 {
   self->settings_key = g_strdup (key);
-  ms_plugin_list_box_scan_phosh_plugins (self);
+  ms_plugin_list_box_populate (self);
 }
 
 
@@ -428,6 +418,7 @@ ms_plugin_list_box_finalize (GObject *object)
   g_clear_pointer (&self->prefs_extension_point, g_free);
   g_clear_pointer (&self->settings_key, g_free);
   g_clear_pointer (&self->plugin_type, g_free);
+  g_clear_pointer (&self->pending_prefs, g_free);
 
   G_OBJECT_CLASS (ms_plugin_list_box_parent_class)->finalize (object);
 }
@@ -509,6 +500,12 @@ ms_plugin_list_box_init (MsPluginListBox *self)
                            create_row,
                            self, NULL);
 
+  g_signal_connect_object (ms_plugin_index_get_default (),
+                           "changed",
+                           G_CALLBACK (ms_plugin_list_box_populate),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   self->action_group = g_simple_action_group_new ();
   g_action_map_add_action_entries (G_ACTION_MAP (self->action_group),
                                    entries,
@@ -532,6 +529,12 @@ ms_plugin_list_box_open_plugin_prefs (MsPluginListBox *self, const char *plugin_
 {
   g_assert (MS_IS_PLUGIN_LIST_BOX (self));
 
+  if (!ms_plugin_index_get_loaded (ms_plugin_index_get_default ())) {
+    g_free (self->pending_prefs);
+    self->pending_prefs = g_strdup (plugin_name);
+    return;
+  }
+
   for (uint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->store)); i++) {
     g_autoptr (MsPluginRow) row = g_list_model_get_item (G_LIST_MODEL (self->store), i);
 
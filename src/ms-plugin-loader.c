@@ -11,6 +11,7 @@
 #include "mobile-settings-config.h"
 
 #include "ms-plugin-loader.h"
+#include "ms-trace.h"
 
 #include <gio/gio.h>
 #include <gtk/gtk.h>
@@ -24,10 +25,11 @@ enum {
 static GParamSpec *props[PROP_LAST_PROP];
 
 struct _MsPluginLoader {
-  GObject parent;
+  GObject  parent;
 
-  GStrv   plugin_dirs;
-  char   *extension_point;
+  GStrv    plugin_dirs;
+  char    *extension_point;
+  gboolean scanned;
 };
 
 G_DEFINE_TYPE (MsPluginLoader, ms_plugin_loader, G_TYPE_OBJECT)
@@ -94,10 +96,31 @@ ms_plugin_loader_constructed (GObject *object)
   ep = g_io_extension_point_register (self->extension_point);
   /* TODO: Make configurable */
   g_io_extension_point_set_required_type (ep, GTK_TYPE_WIDGET);
+}
+
+
+static void
+scan_plugin_dirs (MsPluginLoader *self)
+{
+  if (self->scanned)
+    return;
 
+  self->scanned = TRUE;
+
+  if (!g_module_supported ())
+    return;
+
+  /*
+   * With an up to date giomodule.cache in the directory this only
+   * reads the cache. Modules are then loaded on first use of the
+   * extension point they implement.
+   */
   for (guint i = 0; i < g_strv_length (self->plugin_dirs); i++) {
+    gint64 begin = ms_trace_begin ();
+
     g_debug ("Will load plugins from '%s' for '%s'", self->plugin_dirs[i], self->extension_point);
     g_io_modules_scan_all_in_directory (self->plugin_dirs[i]);
+    ms_trace_end (begin, "plugin-scan", self->plugin_dirs[i]);
   }
 }
 
@@ -174,6 +197,8 @@ ms_plugin_loader_load_plugin (MsPluginLoader *self)
 
   g_return_val_if_fail (MS_IS_PLUGIN_LOADER (self), NULL);
 
+  scan_plugin_dirs (self);
+
   ep = g_io_extension_point_lookup (self->extension_point);
   extensions = g_io_extension_point_get_extensions (ep);
 
@@ -10,13 +10,45 @@
 
 #define DEVICE_TREE_COMPATIBLE_PATH "/sys/firmware/devicetree/base/compatible"
 
+/* The device's compatibles don't change so read them only once */
+static const char * const *
+get_compatibles (void)
+{
+  static GStrv compatibles;
+
+  if (g_once_init_enter_pointer (&compatibles)) {
+    g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+    g_autoptr (GError) err = NULL;
+    g_autofree char *contents = NULL;
+    const char *comp;
+    gsize len = 0;
+
+    if (g_file_get_contents (DEVICE_TREE_COMPATIBLE_PATH, &contents, &len, &err)) {
+      g_debug ("Found device tree device compatible at %s", DEVICE_TREE_COMPATIBLE_PATH);
+
+      comp = contents;
+      while ((gsize)(comp - contents) < len) {
+        g_strv_builder_add (builder, comp);
+
+        /* Next compatible */
+        comp = strchr (comp, 0);
+        comp++;
+      }
+    } else if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+      g_warning ("Unable to read: %s", err->message);
+    }
+
+    g_once_init_leave_pointer (&compatibles, g_strv_builder_end (builder));
+  }
+
+  return (const char * const *) compatibles;
+}
+
+
 gboolean
 ms_plugin_check_device_support (const char * const *supported)
 {
-  gsize len;
-  const char *comp;
-  g_autoptr (GError) err = NULL;
-  g_autofree char *compatibles = NULL;
+  const char * const *compatibles;
   const char *assume_device;
 
   assume_device = g_getenv ("MS_FORCE_DEVICE");
@@ -26,24 +58,10 @@ ms_plugin_check_device_support (const char * const *supported)
   if (assume_device && g_strv_contains (supported, assume_device))
     return TRUE;
 
-  if (g_file_test (DEVICE_TREE_COMPATIBLE_PATH, (G_FILE_TEST_EXISTS)) == FALSE)
-    return FALSE;
-
-  g_debug ("Found device tree device compatible at %s", DEVICE_TREE_COMPATIBLE_PATH);
-
-  if (g_file_get_contents (DEVICE_TREE_COMPATIBLE_PATH, &compatibles, &len, &err) == FALSE) {
-    g_warning ("Unable to read: %s", err->message);
-    return FALSE;
-  }
-
-  comp = compatibles;
-  while ((gsize)(comp - compatibles) < len) {
-    if (g_strv_contains (supported, comp))
+  compatibles = get_compatibles ();
+  for (guint i = 0; compatibles[i]; i++) {
+    if (g_strv_contains (supported, compatibles[i]))
       return TRUE;
-
-    /* Next compatible */
-    comp = strchr (comp, 0);
-    comp++;
   }
 
   return FALSE;
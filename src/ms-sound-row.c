@@ -15,16 +15,13 @@
 
 #include "ms-feedback-panel.h"
 #include "ms-sound-row.h"
+#include "ms-sound-theme-transaction.h"
 
 #include "gmobile.h"
 
 #include <gsound.h>
 #include <glib/gi18n.h>
 
-#define SOUND_KEY_SCHEMA "org.gnome.desktop.sound"
-#define CUSTOM_SOUND_THEME_NAME "__custom"
-#define DIR_MODE 0700
-
 #define GM_STR_IS_NULL_OR_EMPTY(x) ((x) == NULL || (x)[0] == '\0')
 
 /**
@@ -51,20 +48,12 @@ struct _MsSoundRow {
   char                 *effect_name;
 
   GtkFileFilter        *sound_filter;
-  GSettings            *sound_settings;
 
   gboolean              playing;
 };
 G_DEFINE_TYPE (MsSoundRow, ms_sound_row, ADW_TYPE_ACTION_ROW)
 
 
-static char *
-ms_sound_row_get_theme_dir (void)
-{
-  return g_build_filename (g_get_user_data_dir (), "sounds", CUSTOM_SOUND_THEME_NAME, NULL);
-}
-
-
 void
 ms_sound_row_set_playing (MsSoundRow *self, gboolean playing)
 {
@@ -79,98 +68,21 @@ ms_sound_row_set_playing (MsSoundRow *self, gboolean playing)
 }
 
 
-static void
-ms_sound_row_update_dir_mtime (const char *dir_path)
-{
-  g_autoptr (GFile) dir = NULL;
-  g_autoptr (GDateTime) now = NULL;
-  g_autoptr (GError) error = NULL;
-
-  now = g_date_time_new_now_utc ();
-  dir = g_file_new_for_path (dir_path);
-  if (!g_file_set_attribute_uint64 (dir,
-                                    G_FILE_ATTRIBUTE_TIME_MODIFIED,
-                                    g_date_time_to_unix (now),
-                                    G_FILE_QUERY_INFO_NONE,
-                                    NULL,
-                                    &error)) {
-    g_warning ("Failed to update directory modification time for %s: %s",
-               dir_path, error->message);
-  }
-}
-
-
-/* Update the sound theme if needed */
-static void
-ms_sound_row_set_custom_sound_theme (MsSoundRow *self)
-{
-  g_autofree char *dir = NULL;
-  g_autofree char *theme_path = NULL;
-  g_autofree char *sounds_path = NULL;
-  g_autofree char *custom_theme_dir = NULL;
-  g_autoptr (GKeyFile) theme_file = NULL;
-  g_autoptr (GVariant) default_theme = NULL;
-  g_autoptr (GError) load_error = NULL;
-  g_autoptr (GError) save_error = NULL;
-
-  dir = ms_sound_row_get_theme_dir ();
-  theme_path = g_build_filename (dir, "index.theme", NULL);
-
-  default_theme = g_settings_get_default_value (self->sound_settings, "theme-name");
-
-  theme_file = g_key_file_new ();
-  if (!g_key_file_load_from_file (theme_file, theme_path, G_KEY_FILE_KEEP_COMMENTS, &load_error)) {
-    if (!g_error_matches (load_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-      g_printerr ("Failed to load theme file %s: %s", theme_path, load_error->message);
-  }
-
-  custom_theme_dir = g_key_file_get_string (theme_file, "Sound Theme", "Directories", NULL);
-  if (g_strcmp0 (custom_theme_dir, ".")) {
-    /* Translators: "Custom" is the name of a user-defined sound theme */
-    g_key_file_set_string (theme_file, "Sound Theme", "Name", _("Custom"));
-    if (default_theme != NULL)
-      g_key_file_set_string (theme_file, "Sound Theme", "Inherits", g_variant_get_string (default_theme, NULL));
-    g_key_file_set_string (theme_file, "Sound Theme", "Directories", ".");
-
-    if (!g_key_file_save_to_file (theme_file, theme_path, &save_error))
-      g_warning ("Failed to save theme file %s: %s", theme_path, save_error->message);
-  } else {
-    g_debug ("Skipping theme write");
-  }
-
-  /* Ensure canberra's event-sound-cache will get updated */
-  sounds_path = g_build_filename (g_get_user_data_dir (), "sounds", NULL);
-  ms_sound_row_update_dir_mtime (sounds_path);
-
-  g_settings_set_string (self->sound_settings, "theme-name", CUSTOM_SOUND_THEME_NAME);
-}
-
-
 static void
 ms_sound_row_set_symlink (MsSoundRow *self, const char *target_path)
 {
-  g_autofree char *dir = NULL;
-  g_autofree char *link_filename = NULL;
-  g_autofree char *link_name = NULL;
-  g_autoptr (GFile) file = NULL;
-  g_autoptr (GError) error = NULL;
-
-  dir = ms_sound_row_get_theme_dir ();
-  link_filename = g_strdup_printf ("%s.ogg", self->effect_name);
-  link_name = g_build_filename (dir, link_filename, NULL);
-
-  file = g_file_new_for_path (link_name);
-  if (!g_file_delete (file, NULL, &error)) {
-    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-      g_warning ("Failed to remove existing sound symbolic link %s: %s", link_name, error->message);
-  }
-
-  if (target_path) {
-    g_mkdir_with_parents (dir, DIR_MODE);
-    if (!g_file_make_symbolic_link (file, target_path, NULL, &error))
-      g_warning ("Failed to make sound theme symbolic link %s->%s: %s", link_name, target_path, error->message);
-
-    ms_sound_row_set_custom_sound_theme (self);
+  GtkWidget *panel;
+  g_autoptr (MsSoundThemeTransaction) transaction = NULL;
+
+  /* Batch with other changes if possible */
+  panel = gtk_widget_get_ancestor (GTK_WIDGET (self), MS_TYPE_FEEDBACK_PANEL);
+  if (panel) {
+    transaction = g_object_ref (ms_feedback_panel_get_sound_theme (MS_FEEDBACK_PANEL (panel)));
+    ms_sound_theme_transaction_set_sound (transaction, self->effect_name, target_path);
+  } else {
+    transaction = ms_sound_theme_transaction_new ();
+    ms_sound_theme_transaction_set_sound (transaction, self->effect_name, target_path);
+    ms_sound_theme_transaction_commit (transaction);
   }
 }
 
@@ -186,7 +98,7 @@ ms_sound_row_get_target (MsSoundRow *self)
   g_autoptr (GError) error = NULL;
   const char *target;
 
-  dir = ms_sound_row_get_theme_dir ();
+  dir = ms_sound_theme_get_dir ();
   effect_filename = g_strdup_printf ("%s.ogg", self->effect_name);
   path = g_build_filename (dir, effect_filename, NULL);
   file = g_file_new_for_path (path);
@@ -321,6 +233,29 @@ open_filechooser_activated (GtkWidget *widget,  const char* action_name, GVarian
 }
 
 
+static void
+set_filename (MsSoundRow *self, const char *filename, gboolean update_theme)
+{
+  if (g_strcmp0 (self->filename, filename) == 0)
+    return;
+
+  g_free (self->filename);
+  self->filename = g_strdup (filename);
+
+  gtk_widget_action_set_enabled (GTK_WIDGET (self), "sound-row.clear-filename",
+                                 !GM_STR_IS_NULL_OR_EMPTY (self->filename));
+  gtk_widget_action_set_enabled (GTK_WIDGET (self), "sound-row.play-sound",
+                                 !GM_STR_IS_NULL_OR_EMPTY (self->filename));
+  gtk_widget_activate_action (GTK_WIDGET (self), "sound-player.stop", NULL, NULL);
+  ms_sound_row_set_playing (self, FALSE);
+
+  if (update_theme)
+    ms_sound_row_set_symlink (self, self->filename);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FILENAME]);
+}
+
+
 static void
 set_effect_name (MsSoundRow *self, const char *effect_name)
 {
@@ -334,7 +269,8 @@ set_effect_name (MsSoundRow *self, const char *effect_name)
   else
     target = ms_sound_row_get_target (self);
 
-  ms_sound_row_set_filename (self, target);
+  /* The theme already has this file */
+  set_filename (self, target, FALSE);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_EFFECT_NAME]);
 
@@ -381,6 +317,9 @@ ms_sound_row_get_property (GObject    *object,
   case PROP_PLAYING:
     g_value_set_boolean (value, self->playing);
     break;
+  case PROP_EFFECT_NAME:
+    g_value_set_string (value, self->effect_name);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -393,8 +332,6 @@ ms_sound_row_finalize (GObject *object)
 {
   MsSoundRow *self = MS_SOUND_ROW(object);
 
-  g_clear_object (&self->sound_settings);
-
   g_clear_pointer (&self->filename, g_free);
   g_clear_pointer (&self->effect_name, g_free);
 
@@ -467,8 +404,6 @@ ms_sound_row_init (MsSoundRow *self)
                                NULL,
                                NULL,
                                NULL);
-
-  self->sound_settings = g_settings_new (SOUND_KEY_SCHEMA);
 }
 
 
@@ -484,20 +419,5 @@ ms_sound_row_set_filename (MsSoundRow *self, const char *filename)
 {
   g_return_if_fail (MS_IS_SOUND_ROW (self));
 
-  if (g_strcmp0 (self->filename, filename) == 0)
-    return;
-
-  g_free (self->filename);
-  self->filename = g_strdup (filename);
-
-  gtk_widget_action_set_enabled (GTK_WIDGET (self), "sound-row.clear-filename",
-                                 !GM_STR_IS_NULL_OR_EMPTY (self->filename));
-  gtk_widget_action_set_enabled (GTK_WIDGET (self), "sound-row.play-sound",
-                                 !GM_STR_IS_NULL_OR_EMPTY (self->filename));
-  gtk_widget_activate_action (GTK_WIDGET (self), "sound-player.stop", NULL, NULL);
-  ms_sound_row_set_playing (self, FALSE);
-
-  ms_sound_row_set_symlink (self, self->filename);
-
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FILENAME]);
+  set_filename (self, filename, TRUE);
 }
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * The handling of .local/share/sounds is based on cc-alert-chooser-window.c in
+ * GNOME Settings which is:
+ * Copyright (C) 2018 Canonical Ltd.
+ * Copyright (C) 2023 Marco Melorio
+ */
+
+#define G_LOG_DOMAIN "ms-sound-theme-transaction"
+
+#include "mobile-settings-config.h"
+
+#include "ms-sound-theme-transaction.h"
+
+#include <gio/gio.h>
+#include <glib/gi18n.h>
+
+#define SOUND_KEY_SCHEMA "org.gnome.desktop.sound"
+#define CUSTOM_SOUND_THEME_NAME "__custom"
+#define DIR_MODE 0700
+
+/* Wait for more changes before touching the theme */
+#define COMMIT_DELAY_MS 1000
+
+/**
+ * MsSoundThemeTransaction:
+ *
+ * Stages changes to the custom sound theme and commits them in one go:
+ * Symlinks get updated, `index.theme` is written and the sounds
+ * directory's mtime gets bumped (which invalidates canberra's event
+ * sound cache) only once per commit. Changes are committed
+ * automatically after a short delay or when committed explicitly.
+ */
+
+struct _MsSoundThemeTransaction {
+  GObject     parent;
+
+  GSettings  *sound_settings;
+  /* effect name -> target path, NULL to remove the sound */
+  GHashTable *staged;
+  guint       commit_id;
+};
+G_DEFINE_TYPE (MsSoundThemeTransaction, ms_sound_theme_transaction, G_TYPE_OBJECT)
+
+
+static void
+update_dir_mtime (const char *dir_path)
+{
+  g_autoptr (GFile) dir = NULL;
+  g_autoptr (GDateTime) now = NULL;
+  g_autoptr (GError) error = NULL;
+
+  now = g_date_time_new_now_utc ();
+  dir = g_file_new_for_path (dir_path);
+  if (!g_file_set_attribute_uint64 (dir,
+                                    G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                    g_date_time_to_unix (now),
+                                    G_FILE_QUERY_INFO_NONE,
+                                    NULL,
+                                    &error)) {
+    g_warning ("Failed to update directory modification time for %s: %s",
+               dir_path, error->message);
+  }
+}
+
+
+/* Update the sound theme if needed */
+static void
+set_custom_sound_theme (MsSoundThemeTransaction *self)
+{
+  g_autofree char *dir = NULL;
+  g_autofree char *theme_path = NULL;
+  g_autofree char *sounds_path = NULL;
+  g_autofree char *custom_theme_dir = NULL;
+  g_autoptr (GKeyFile) theme_file = NULL;
+  g_autoptr (GVariant) default_theme = NULL;
+  g_autoptr (GError) load_error = NULL;
+  g_autoptr (GError) save_error = NULL;
+
+  dir = ms_sound_theme_get_dir ();
+  theme_path = g_build_filename (dir, "index.theme", NULL);
+
+  default_theme = g_settings_get_default_value (self->sound_settings, "theme-name");
+
+  theme_file = g_key_file_new ();
+  if (!g_key_file_load_from_file (theme_file, theme_path, G_KEY_FILE_KEEP_COMMENTS, &load_error)) {
+    if (!g_error_matches (load_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_printerr ("Failed to load theme file %s: %s", theme_path, load_error->message);
+  }
+
+  custom_theme_dir = g_key_file_get_string (theme_file, "Sound Theme", "Directories", NULL);
+  if (g_strcmp0 (custom_theme_dir, ".")) {
+    /* Translators: "Custom" is the name of a user-defined sound theme */
+    g_key_file_set_string (theme_file, "Sound Theme", "Name", _("Custom"));
+    if (default_theme != NULL)
+      g_key_file_set_string (theme_file, "Sound Theme", "Inherits", g_variant_get_string (default_theme, NULL));
+    g_key_file_set_string (theme_file, "Sound Theme", "Directories", ".");
+
+    if (!g_key_file_save_to_file (theme_file, theme_path, &save_error))
+      g_warning ("Failed to save theme file %s: %s", theme_path, save_error->message);
+  } else {
+    g_debug ("Skipping theme write");
+  }
+
+  /* Ensure canberra's event-sound-cache will get updated */
+  sounds_path = g_build_filename (g_get_user_data_dir (), "sounds", NULL);
+  update_dir_mtime (sounds_path);
+
+  g_settings_set_string (self->sound_settings, "theme-name", CUSTOM_SOUND_THEME_NAME);
+}
+
+
+static void
+set_symlink (const char *dir, const char *effect_name, const char *target_path)
+{
+  g_autofree char *link_filename = NULL;
+  g_autofree char *link_name = NULL;
+  g_autoptr (GFile) file = NULL;
+  g_autoptr (GError) error = NULL;
+
+  link_filename = g_strdup_printf ("%s.ogg", effect_name);
+  link_name = g_build_filename (dir, link_filename, NULL);
+
+  file = g_file_new_for_path (link_name);
+  if (!g_file_delete (file, NULL, &error)) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+      g_warning ("Failed to remove existing sound symbolic link %s: %s", link_name, error->message);
+    g_clear_error (&error);
+  }
+
+  if (target_path == NULL)
+    return;
+
+  g_mkdir_with_parents (dir, DIR_MODE);
+  if (!g_file_make_symbolic_link (file, target_path, NULL, &error))
+    g_warning ("Failed to make sound theme symbolic link %s->%s: %s", link_name, target_path, error->message);
+}
+
+
+static gboolean
+on_commit_timeout (gpointer user_data)
+{
+  MsSoundThemeTransaction *self = MS_SOUND_THEME_TRANSACTION (user_data);
+
+  self->commit_id = 0;
+  ms_sound_theme_transaction_commit (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+ms_sound_theme_transaction_dispose (GObject *object)
+{
+  MsSoundThemeTransaction *self = MS_SOUND_THEME_TRANSACTION (object);
+
+  if (self->staged)
+    ms_sound_theme_transaction_commit (self);
+
+  g_clear_pointer (&self->staged, g_hash_table_unref);
+  g_clear_object (&self->sound_settings);
+
+  G_OBJECT_CLASS (ms_sound_theme_transaction_parent_class)->dispose (object);
+}
+
+
+static void
+ms_sound_theme_transaction_class_init (MsSoundThemeTransactionClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ms_sound_theme_transaction_dispose;
+}
+
+
+static void
+ms_sound_theme_transaction_init (MsSoundThemeTransaction *self)
+{
+  self->sound_settings = g_settings_new (SOUND_KEY_SCHEMA);
+  self->staged = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+
+MsSoundThemeTransaction *
+ms_sound_theme_transaction_new (void)
+{
+  return g_object_new (MS_TYPE_SOUND_THEME_TRANSACTION, NULL);
+}
+
+/**
+ * ms_sound_theme_transaction_set_sound:
+ * @self: The transaction
+ * @effect_name: The sound's event id
+ * @target_path:(nullable): The sound file to use or %NULL to remove the sound
+ *
+ * Stage a sound change. A later change for the same effect replaces
+ * the staged one.
+ */
+void
+ms_sound_theme_transaction_set_sound (MsSoundThemeTransaction *self,
+                                      const char              *effect_name,
+                                      const char              *target_path)
+{
+  g_return_if_fail (MS_IS_SOUND_THEME_TRANSACTION (self));
+  g_return_if_fail (effect_name);
+
+  g_hash_table_insert (self->staged, g_strdup (effect_name), g_strdup (target_path));
+
+  g_clear_handle_id (&self->commit_id, g_source_remove);
+  self->commit_id = g_timeout_add (COMMIT_DELAY_MS, on_commit_timeout, self);
+  g_source_set_name_by_id (self->commit_id, "[ms] commit sound theme");
+}
+
+/**
+ * ms_sound_theme_transaction_commit:
+ * @self: The transaction
+ *
+ * Apply all staged changes now.
+ */
+void
+ms_sound_theme_transaction_commit (MsSoundThemeTransaction *self)
+{
+  g_autofree char *dir = NULL;
+  gboolean added = FALSE;
+  GHashTableIter iter;
+  const char *effect_name, *target_path;
+
+  g_return_if_fail (MS_IS_SOUND_THEME_TRANSACTION (self));
+
+  g_clear_handle_id (&self->commit_id, g_source_remove);
+  if (g_hash_table_size (self->staged) == 0)
+    return;
+
+  g_debug ("Committing %u sound theme changes", g_hash_table_size (self->staged));
+
+  dir = ms_sound_theme_get_dir ();
+  g_hash_table_iter_init (&iter, self->staged);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &effect_name, (gpointer *) &target_path)) {
+    set_symlink (dir, effect_name, target_path);
+    added |= target_path != NULL;
+  }
+  g_hash_table_remove_all (self->staged);
+
+  if (added)
+    set_custom_sound_theme (self);
+}
+
+/**
+ * ms_sound_theme_get_dir:
+ *
+ * Get the directory of the custom sound theme.
+ *
+ * Returns: The directory
+ */
+char *
+ms_sound_theme_get_dir (void)
+{
+  return g_build_filename (g_get_user_data_dir (), "sounds", CUSTOM_SOUND_THEME_NAME, NULL);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MS_TYPE_SOUND_THEME_TRANSACTION (ms_sound_theme_transaction_get_type ())
+
+G_DECLARE_FINAL_TYPE (MsSoundThemeTransaction, ms_sound_theme_transaction, MS,
+                      SOUND_THEME_TRANSACTION, GObject)
+
+MsSoundThemeTransaction *ms_sound_theme_transaction_new       (void);
+void                     ms_sound_theme_transaction_set_sound (MsSoundThemeTransaction *self,
+                                                               const char              *effect_name,
+                                                               const char              *target_path);
+void                     ms_sound_theme_transaction_commit    (MsSoundThemeTransaction *self);
+char                    *ms_sound_theme_get_dir               (void);
+
+G_END_DECLS
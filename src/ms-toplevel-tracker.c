@@ -14,6 +14,18 @@
 
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 
+#include <gtk/gtk.h>
+
+/**
+ * MsToplevelTracker:
+ *
+ * Tracks the app-ids of the open toplevels. The app-ids are exposed as
+ * a list model of [class@Gtk.StringObject]s with one item per app-id no
+ * matter how many toplevels use it. A toplevel's app-id changes are
+ * applied on its `done` event resulting in a single `items-changed` and
+ * [signal@ToplevelTracker::changed] emission.
+ */
+
 enum {
   PROP_0,
   PROP_FOREIGN_TOPLEVEL_MANAGER,
@@ -23,8 +35,7 @@ static GParamSpec *props[PROP_LAST_PROP];
 
 
 enum {
-  APP_ID_ADDED,
-  APP_ID_REMOVED,
+  CHANGED,
   N_SIGNALS
 };
 static guint signals[N_SIGNALS];
@@ -32,6 +43,7 @@ static guint signals[N_SIGNALS];
 
 typedef struct {
   char *app_id;
+  char *pending_app_id;
   char *title;
 
   struct zwlr_foreign_toplevel_handle_v1 *handle;
@@ -39,16 +51,84 @@ typedef struct {
 } MsToplevel;
 
 
+typedef struct {
+  GtkStringObject *item; /* unowned */
+  guint            n_toplevels;
+} MsAppId;
+
+
 struct _MsToplevelTracker {
   GObject               parent;
 
   GHashTable           *toplevels;
+  /* app-id → MsAppId */
   GHashTable           *app_ids;
+  GPtrArray            *items;
 
   struct zwlr_foreign_toplevel_manager_v1 *foreign_toplevel_manager;
 };
 
-G_DEFINE_TYPE (MsToplevelTracker, ms_toplevel_tracker, G_TYPE_OBJECT)
+static void ms_list_model_iface_init (GListModelInterface *iface);
+G_DEFINE_TYPE_WITH_CODE (MsToplevelTracker, ms_toplevel_tracker, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, ms_list_model_iface_init))
+
+
+static void
+update_app_id (MsToplevelTracker *self, const char *old_app_id, const char *new_app_id)
+{
+  g_autoptr (GStrvBuilder) added = g_strv_builder_new ();
+  g_autoptr (GStrvBuilder) removed = g_strv_builder_new ();
+  g_autoptr (GStrvBuilder) modified = g_strv_builder_new ();
+  g_auto (GStrv) added_ids = NULL;
+  g_auto (GStrv) removed_ids = NULL;
+  g_auto (GStrv) modified_ids = NULL;
+  guint n_items = self->items->len, first = n_items;
+  MsAppId *entry;
+
+  if (g_strcmp0 (old_app_id, new_app_id) == 0)
+    return;
+
+  if (old_app_id) {
+    entry = g_hash_table_lookup (self->app_ids, old_app_id);
+    if (entry == NULL) {
+      g_warning ("Failed to find app-id %s in toplevel tracker", old_app_id);
+    } else if (entry->n_toplevels == 1) {
+      /* We're removing the last toplevel with that app-id */
+      g_debug ("No toplevels with app-id %s remain", old_app_id);
+      g_ptr_array_find (self->items, entry->item, &first);
+      g_ptr_array_remove_index (self->items, first);
+      g_hash_table_remove (self->app_ids, old_app_id);
+      g_strv_builder_add (removed, old_app_id);
+    } else {
+      entry->n_toplevels--;
+      g_debug ("%u toplevels with app-id %s remain", entry->n_toplevels, old_app_id);
+      g_strv_builder_add (modified, old_app_id);
+    }
+  }
+
+  if (new_app_id) {
+    entry = g_hash_table_lookup (self->app_ids, new_app_id);
+    if (entry == NULL) {
+      entry = g_new0 (MsAppId, 1);
+      entry->item = gtk_string_object_new (new_app_id);
+      g_ptr_array_add (self->items, entry->item);
+      g_hash_table_insert (self->app_ids, g_strdup (new_app_id), entry);
+      g_strv_builder_add (added, new_app_id);
+    } else {
+      g_strv_builder_add (modified, new_app_id);
+    }
+    entry->n_toplevels++;
+    g_debug ("%u toplevels with app-id %s", entry->n_toplevels, new_app_id);
+  }
+
+  if (first < n_items || self->items->len > n_items)
+    g_list_model_items_changed (G_LIST_MODEL (self), first, n_items - first, self->items->len - first);
+
+  added_ids = g_strv_builder_end (added);
+  removed_ids = g_strv_builder_end (removed);
+  modified_ids = g_strv_builder_end (modified);
+  g_signal_emit (self, signals[CHANGED], 0, added_ids, removed_ids, modified_ids);
+}
 
 
 static void
@@ -72,19 +152,10 @@ handle_zwlr_foreign_toplevel_handle_app_id (void *data,
   const char* app_id)
 {
   MsToplevel *toplevel = data;
-  int num;
-
-  g_free (toplevel->app_id);
-  toplevel->app_id = g_strdup (app_id);
-
-  num = GPOINTER_TO_INT (g_hash_table_lookup (toplevel->tracker->app_ids, app_id));
-  if (num == 0) {
-    g_signal_emit (toplevel->tracker, signals[APP_ID_ADDED], 0, app_id);
-  }
 
-  num++;
-  g_debug ("%d toplevels with app-id %s", num, app_id);
-  g_hash_table_insert (toplevel->tracker->app_ids, g_strdup (app_id), GINT_TO_POINTER (num));
+  /* Applied on done */
+  g_free (toplevel->pending_app_id);
+  toplevel->pending_app_id = g_strdup (app_id);
 }
 
 
@@ -116,6 +187,14 @@ static void
 handle_zwlr_foreign_toplevel_handle_done (void *data,
   struct zwlr_foreign_toplevel_handle_v1 *zwlr_foreign_toplevel_handle_v1)
 {
+  MsToplevel *toplevel = data;
+
+  if (toplevel->pending_app_id == NULL)
+    return;
+
+  update_app_id (toplevel->tracker, toplevel->app_id, toplevel->pending_app_id);
+  g_free (toplevel->app_id);
+  toplevel->app_id = g_steal_pointer (&toplevel->pending_app_id);
 }
 
 
@@ -124,22 +203,11 @@ handle_zwlr_foreign_toplevel_handle_closed (void *data,
   struct zwlr_foreign_toplevel_handle_v1 *zwlr_foreign_toplevel_handle_v1)
 {
   MsToplevel *toplevel = data;
-  int num;
 
   g_return_if_fail (toplevel->handle == zwlr_foreign_toplevel_handle_v1);
 
-  num = GPOINTER_TO_INT (g_hash_table_lookup (toplevel->tracker->app_ids, toplevel->app_id));
-  num--;
-  if (num == 0) {
-    /* We're removing the last toplevel with that app-id */
-    g_signal_emit (toplevel->tracker, signals[APP_ID_REMOVED], 0, toplevel->app_id);
-    g_hash_table_remove (toplevel->tracker->app_ids, toplevel->app_id);
-  } else {
-    g_hash_table_insert (toplevel->tracker->app_ids, g_strdup (toplevel->app_id),
-                         GINT_TO_POINTER (num));
-  }
+  update_app_id (toplevel->tracker, toplevel->app_id, NULL);
 
-  g_debug ("%d toplevels with app-id %s remain", num, toplevel->app_id);
   if (g_hash_table_remove (toplevel->tracker->toplevels, toplevel->handle) == FALSE)
     g_warning ("Failed to find %p handle in toplevel tracker", toplevel->handle);
 }
@@ -162,6 +230,7 @@ toplevel_destroy (gpointer data)
   MsToplevel *toplevel = data;
 
   g_clear_pointer (&toplevel->app_id, g_free);
+  g_clear_pointer (&toplevel->pending_app_id, g_free);
   g_clear_pointer (&toplevel->title, g_free);
   g_clear_pointer (&toplevel->handle, zwlr_foreign_toplevel_handle_v1_destroy);
 
@@ -212,6 +281,43 @@ static const struct zwlr_foreign_toplevel_manager_v1_listener zwlr_foreign_tople
 };
 
 
+static GType
+ms_list_model_get_item_type (GListModel *list)
+{
+  return GTK_TYPE_STRING_OBJECT;
+}
+
+
+static gpointer
+ms_list_model_get_item (GListModel *list, guint position)
+{
+  MsToplevelTracker *self = MS_TOPLEVEL_TRACKER (list);
+
+  if (position >= self->items->len)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (self->items, position));
+}
+
+
+static unsigned int
+ms_list_model_get_n_items (GListModel *list)
+{
+  MsToplevelTracker *self = MS_TOPLEVEL_TRACKER (list);
+
+  return self->items->len;
+}
+
+
+static void
+ms_list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = ms_list_model_get_item_type;
+  iface->get_item = ms_list_model_get_item;
+  iface->get_n_items = ms_list_model_get_n_items;
+}
+
+
 static void
 ms_toplevel_tracker_set_property (GObject      *object,
                                   guint         property_id,
@@ -269,6 +375,7 @@ ms_toplevel_tracker_finalize (GObject *object)
 
   g_clear_pointer (&self->toplevels, g_hash_table_destroy);
   g_clear_pointer (&self->app_ids, g_hash_table_destroy);
+  g_clear_pointer (&self->items, g_ptr_array_unref);
 
   G_OBJECT_CLASS (ms_toplevel_tracker_parent_class)->finalize (object);
 }
@@ -290,27 +397,27 @@ ms_toplevel_tracker_class_init (MsToplevelTrackerClass *klass)
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 
-  signals[APP_ID_ADDED] = g_signal_new ("app-id-added",
-                                        G_TYPE_FROM_CLASS (klass),
-                                        G_SIGNAL_RUN_LAST,
-                                        0, /* class offset */
-                                        NULL, /* accumulator */
-                                        NULL, /* accu_data */
-                                        NULL, /* marshaller */
-                                        G_TYPE_NONE, /* return */
-                                        1, /* n_params */
-                                        G_TYPE_STRING);
-
-  signals[APP_ID_REMOVED] = g_signal_new ("app-id-removed",
-                                          G_TYPE_FROM_CLASS (klass),
-                                          G_SIGNAL_RUN_LAST,
-                                          0, /* class_offset */
-                                          NULL, /* accumulator */
-                                          NULL, /* accu_data */
-                                          NULL, /* marshaller */
-                                          G_TYPE_NONE, /* return */
-                                          1, /* n_params */
-                                          G_TYPE_STRING);
+  /**
+   * MsToplevelTracker::changed:
+   * @self: The toplevel tracker
+   * @added: The app-ids that got added
+   * @removed: The app-ids that got removed
+   * @modified: The app-ids that gained or lost a toplevel
+   *
+   * Emitted once per toplevel update after the list model got updated.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, /* class offset */
+                                   NULL, /* accumulator */
+                                   NULL, /* accu_data */
+                                   NULL, /* marshaller */
+                                   G_TYPE_NONE, /* return */
+                                   3, /* n_params */
+                                   G_TYPE_STRV | G_SIGNAL_TYPE_STATIC_SCOPE,
+                                   G_TYPE_STRV | G_SIGNAL_TYPE_STATIC_SCOPE,
+                                   G_TYPE_STRV | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 
@@ -318,7 +425,8 @@ static void
 ms_toplevel_tracker_init (MsToplevelTracker *self)
 {
   self->toplevels = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, toplevel_destroy);
-  self->app_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->app_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->items = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 
@@ -330,20 +438,3 @@ ms_toplevel_tracker_new (gpointer foreign_toplevel_manager)
                                             NULL));
 }
 
-
-GStrv
-ms_toplevel_tracker_get_app_ids (MsToplevelTracker *self)
-{
-  g_autoptr (GList) keys = NULL;
-  g_autoptr (GPtrArray) app_ids = NULL;
-
-  keys = g_hash_table_get_keys (self->app_ids);
-
-  app_ids = g_ptr_array_new ();
-  for (GList *elem = keys; elem; elem = elem->next)
-    g_ptr_array_add (app_ids, g_strdup (elem->data));
-
-  g_ptr_array_add (app_ids, NULL);
-
-  return (char **)g_ptr_array_steal (app_ids, NULL);
-}
@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -15,6 +15,5 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (MsToplevelTracker, ms_toplevel_tracker, MS, TOPLEVEL_TRACKER, GObject)
 
 MsToplevelTracker *ms_toplevel_tracker_new (gpointer foreign_toplevel_manager);
-GStrv              ms_toplevel_tracker_get_app_ids (MsToplevelTracker *self);
 
 G_END_DECLS
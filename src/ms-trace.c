@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ms-trace"
+
+#include "mobile-settings-config.h"
+
+#include "ms-trace.h"
+
+#ifdef MOBILE_SETTINGS_HAVE_SYSPROF
+# include <sysprof-capture.h>
+#endif
+
+/*
+ * Lightweight tracing of startup and panel construction. Spans are
+ * sent to sysprof when built with sysprof support. With `MS_TRACE=1`
+ * spans are also collected and summarized once the window gets hidden
+ * (as in resident mode we never exit) or on exit. `--startup-profile`
+ * prints them once the first frame got presented.
+ */
+
+typedef struct {
+  char   *name;
+  char   *detail;
+  gint64  begin;
+  gint64  duration;
+} MsTraceSpan;
+
+static GMutex     spans_lock;
+static GArray    *spans;
+static gint64     process_start;
+static gboolean   summary_on_exit;
+static gboolean   summary_printed;
+static gboolean   startup_profile;
+
+
+static void
+clear_span (MsTraceSpan *span)
+{
+  g_free (span->name);
+  g_free (span->detail);
+}
+
+
+static gboolean
+collecting (void)
+{
+  return summary_on_exit || startup_profile;
+}
+
+/**
+ * ms_trace_init:
+ *
+ * Initialize tracing. Call this as early as possible as all times
+ * are relative to this.
+ */
+void
+ms_trace_init (void)
+{
+  process_start = g_get_monotonic_time ();
+  summary_on_exit = g_strcmp0 (g_getenv ("MS_TRACE"), "1") == 0;
+
+  spans = g_array_new (FALSE, TRUE, sizeof (MsTraceSpan));
+  g_array_set_clear_func (spans, (GDestroyNotify) clear_span);
+}
+
+
+static void
+print_summary (void)
+{
+  g_autoptr (GHashTable) totals = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  g_autoptr (GList) keys = NULL;
+
+  for (guint i = 0; i < spans->len; i++) {
+    MsTraceSpan *span = &g_array_index (spans, MsTraceSpan, i);
+    g_autofree char *key = NULL;
+    gint64 *total;
+
+    key = span->detail ? g_strdup_printf ("%s: %s", span->name, span->detail) : g_strdup (span->name);
+    total = g_hash_table_lookup (totals, key);
+    if (total == NULL) {
+      /* total duration and count */
+      total = g_new0 (gint64, 2);
+      g_hash_table_insert (totals, g_steal_pointer (&key), total);
+    }
+    total[0] += span->duration;
+    total[1]++;
+  }
+
+  keys = g_hash_table_get_keys (totals);
+  keys = g_list_sort (keys, (GCompareFunc) g_strcmp0);
+
+  g_print ("Trace summary:\n");
+  for (GList *l = keys; l; l = l->next) {
+    gint64 *total = g_hash_table_lookup (totals, l->data);
+
+    g_print ("  %-40s %4" G_GINT64_FORMAT "x %10.3f ms\n",
+             (char *) l->data, total[1], total[0] / 1000.0);
+  }
+}
+
+
+static void
+print_startup_profile (void)
+{
+  g_print ("Startup profile (ms since process start):\n");
+  for (guint i = 0; i < spans->len; i++) {
+    MsTraceSpan *span = &g_array_index (spans, MsTraceSpan, i);
+
+    g_print ("  %10.3f %+10.3f  %s%s%s\n",
+             (span->begin - process_start) / 1000.0,
+             span->duration / 1000.0,
+             span->name,
+             span->detail ? ": " : "",
+             span->detail ?: "");
+  }
+}
+
+/**
+ * ms_trace_shutdown:
+ *
+ * Print the summary if requested and free all collected spans.
+ */
+void
+ms_trace_shutdown (void)
+{
+  g_mutex_lock (&spans_lock);
+
+  if (summary_on_exit && !summary_printed && spans)
+    print_summary ();
+
+  g_clear_pointer (&spans, g_array_unref);
+
+  g_mutex_unlock (&spans_lock);
+}
+
+/**
+ * ms_trace_set_startup_profile:
+ * @enable: Whether to print the startup profile
+ *
+ * Print a per phase breakdown once startup is done. Spans are only
+ * collected once this is set so call it before the application
+ * object is created.
+ */
+void
+ms_trace_set_startup_profile (gboolean enable)
+{
+  startup_profile = enable;
+}
+
+/**
+ * ms_trace_is_enabled:
+ *
+ * Returns: %TRUE if spans are recorded
+ */
+gboolean
+ms_trace_is_enabled (void)
+{
+#ifdef MOBILE_SETTINGS_HAVE_SYSPROF
+  return TRUE;
+#else
+  return collecting ();
+#endif
+}
+
+/**
+ * ms_trace_begin:
+ *
+ * Start a span. Pass the returned value to `ms_trace_end()`.
+ *
+ * Returns: The start time of the span or `0` if tracing is off
+ */
+gint64
+ms_trace_begin (void)
+{
+  if (!ms_trace_is_enabled ())
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+/**
+ * ms_trace_end:
+ * @begin: The start as returned by `ms_trace_begin()`
+ * @name: The name of the span
+ * @detail:(nullable): Additional information, e.g. the panel's name
+ *
+ * End a span started with `ms_trace_begin()`.
+ */
+void
+ms_trace_end (gint64 begin, const char *name, const char *detail)
+{
+  MsTraceSpan span;
+  gint64 now;
+
+  if (begin == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+
+#ifdef MOBILE_SETTINGS_HAVE_SYSPROF
+  sysprof_collector_mark (begin * 1000,
+                          (now - begin) * 1000,
+                          "phosh-mobile-settings",
+                          name,
+                          detail ?: "");
+#endif
+
+  if (!collecting ())
+    return;
+
+  span = (MsTraceSpan) {
+    .name = g_strdup (name),
+    .detail = g_strdup (detail),
+    .begin = begin,
+    .duration = now - begin,
+  };
+
+  g_mutex_lock (&spans_lock);
+  if (spans)
+    g_array_append_val (spans, span);
+  else
+    clear_span (&span);
+  g_mutex_unlock (&spans_lock);
+}
+
+/**
+ * ms_trace_get_process_start:
+ *
+ * Returns: The monotonic time when tracing was initialized
+ */
+gint64
+ms_trace_get_process_start (void)
+{
+  return process_start;
+}
+
+/**
+ * ms_trace_startup_done:
+ *
+ * Marks the end of startup (the first frame got presented) and prints
+ * the startup profile if requested.
+ */
+void
+ms_trace_startup_done (void)
+{
+  static gboolean done;
+
+  if (done || !ms_trace_is_enabled ())
+    return;
+  done = TRUE;
+
+  /* A span covering the whole startup */
+  ms_trace_end (process_start, "first-frame", NULL);
+
+  if (!startup_profile)
+    return;
+
+  g_mutex_lock (&spans_lock);
+  if (spans)
+    print_startup_profile ();
+  g_mutex_unlock (&spans_lock);
+}
+
+/**
+ * ms_trace_window_hidden:
+ *
+ * Marks that the main window got hidden and prints the summary
+ * collected so far if requested. Only the first call has an effect.
+ */
+void
+ms_trace_window_hidden (void)
+{
+  g_mutex_lock (&spans_lock);
+  if (summary_on_exit && !summary_printed && spans) {
+    print_summary ();
+    summary_printed = TRUE;
+  }
+  g_mutex_unlock (&spans_lock);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void     ms_trace_init                (void);
+void     ms_trace_shutdown            (void);
+void     ms_trace_set_startup_profile (gboolean enable);
+gboolean ms_trace_is_enabled          (void);
+gint64   ms_trace_begin               (void);
+void     ms_trace_end                 (gint64      begin,
+                                       const char *name,
+                                       const char *detail);
+void     ms_trace_startup_done        (void);
+void     ms_trace_window_hidden       (void);
+gint64   ms_trace_get_process_start   (void);
+
+G_END_DECLS
@@ -445,7 +445,7 @@ ms_updates_panel_init (MsUpdatesPanel *self)
   gtk_widget_init_template (GTK_WIDGET (self));
 
   self->cancel = g_cancellable_new ();
-  self->os_updater = ms_get_default_os_updater_sync ();
+  self->os_updater = ms_get_default_os_updater ();
   g_object_bind_property (self->os_updater, "supported",
                           self, "enabled",
                           G_BINDING_SYNC_CREATE);
@@ -7,6 +7,9 @@
  * Author: Guido Günther <agx@sigxcpu.org>
  */
 
+#include "mobile-settings-config.h"
+
+#include "ms-app-info-registry.h"
 #include <ms-util.h>
 #include <glib/gi18n.h>
 
@@ -16,6 +19,10 @@
 #include <gtk/gtk.h>
 #include <adwaita.h>
 
+#ifdef MOBILE_SETTINGS_HAVE_MALLOC_TRIM
+# include <malloc.h>
+#endif
+
 /* Combining diacritical mark?
  *  Basic range: [0x0300,0x036F]
  *  Supplement:  [0x1DC0,0x1DFF]
@@ -79,54 +86,14 @@ ms_munge_app_id (const char *app_id)
 GDesktopAppInfo *
 ms_get_desktop_app_info_for_app_id (const char *app_id)
 {
-  g_autofree char *desktop_id = NULL;
-  g_autofree char *lowercase = NULL;
-  GDesktopAppInfo *app_info = NULL;
-  char *last_component;
-  static char *mappings[][2] = {
-    { "org.gnome.ControlCenter", "gnome-control-center" },
-    { "gnome-usage", "org.gnome.Usage" },
-  };
+  MsAppInfoRegistry *registry = ms_app_info_registry_get_default ();
+  GDesktopAppInfo *app_info;
 
   g_assert (app_id);
 
-  /* fix up applications with known broken app-id */
-  for (guint i = 0; i < G_N_ELEMENTS (mappings); i++) {
-    if (strcmp (app_id, mappings[i][0]) == 0) {
-      app_id = mappings[i][1];
-      break;
-    }
-  }
-
-  desktop_id = g_strdup_printf ("%s.desktop", app_id);
-  g_return_val_if_fail (desktop_id, NULL);
-  app_info = g_desktop_app_info_new (desktop_id);
-
-  if (app_info)
-    return app_info;
-
-  /* try to handle the case where app-id is rev-DNS, but desktop file is not */
-  last_component = strrchr(app_id, '.');
-  if (last_component) {
-    g_free (desktop_id);
-    desktop_id = g_strdup_printf ("%s.desktop", last_component + 1);
-    g_return_val_if_fail (desktop_id, NULL);
-    app_info = g_desktop_app_info_new (desktop_id);
-    if (app_info)
-      return app_info;
-  }
-
-  /* X11 WM_CLASS is often capitalized, so try in lowercase as well */
-  lowercase = g_utf8_strdown (last_component ?: app_id, -1);
-  g_free (desktop_id);
-  desktop_id = g_strdup_printf ("%s.desktop", lowercase);
-  g_return_val_if_fail (desktop_id, NULL);
-  app_info = g_desktop_app_info_new (desktop_id);
+  app_info = ms_app_info_registry_lookup_app_id (registry, app_id);
 
-  if (!app_info)
-    g_message ("Could not find application for app-id '%s'", app_id);
-
-  return app_info;
+  return app_info ? g_object_ref (app_info) : NULL;
 }
 
 
@@ -485,15 +452,21 @@ ms_get_media_role_as_string (MsMediaRole role)
 }
 
 
-void
-ms_util_end_session (MsEndSessionMode mode)
+static void
+on_session_proxy_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+  MsEndSessionMode mode = GPOINTER_TO_INT (user_data);
   g_autoptr (GDBusProxy) proxy = NULL;
   g_autoptr (GError) err = NULL;
-  g_autoptr (GVariant) ret = NULL;
   const char *method;
   GVariant *arg = NULL;
 
+  proxy = g_dbus_proxy_new_for_bus_finish (res, &err);
+  if (!proxy) {
+    g_warning ("Failed to get session proxy: %s", err->message);
+    return;
+  }
+
   switch (mode) {
   case MS_END_SESSION_MODE_REBOOT:
     method = "Reboot";
@@ -504,20 +477,6 @@ ms_util_end_session (MsEndSessionMode mode)
     arg = g_variant_new ("(u)", 0);
   }
 
-  /* We log out so sync call is fine */
-  proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                         G_DBUS_PROXY_FLAGS_NONE,
-                                         NULL,
-                                         "org.gnome.SessionManager",
-                                         "/org/gnome/SessionManager",
-                                         "org.gnome.SessionManager",
-                                         NULL,
-                                         &err);
-  if (!proxy) {
-    g_warning ("Failed to get session proxy: %s", err->message);
-    return;
-  }
-
   g_dbus_proxy_call (proxy,
                      method,
                      arg,
@@ -527,3 +486,115 @@ ms_util_end_session (MsEndSessionMode mode)
                      NULL,
                      NULL);
 }
+
+
+void
+ms_util_end_session (MsEndSessionMode mode)
+{
+  g_dbus_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                            G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                            G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+                            NULL,
+                            "org.gnome.SessionManager",
+                            "/org/gnome/SessionManager",
+                            "org.gnome.SessionManager",
+                            NULL,
+                            on_session_proxy_ready,
+                            GINT_TO_POINTER (mode));
+}
+
+/**
+ * ms_util_trim_memory:
+ *
+ * Return freed heap memory to the system where supported.
+ */
+void
+ms_util_trim_memory (void)
+{
+#ifdef MOBILE_SETTINGS_HAVE_MALLOC_TRIM
+  malloc_trim (0);
+#endif
+}
+
+
+/*
+ * Check if @new_items is @old_items with the first (@step > 0) or last
+ * (@step < 0) item moved to the other end.
+ */
+static gboolean
+is_rotated (gpointer *old_items, gpointer *new_items, guint len, int step, GEqualFunc equal)
+{
+  guint first = step > 0 ? 0 : len - 1;
+  guint last = step > 0 ? len - 1 : 0;
+
+  if (!equal (old_items[first], new_items[last]))
+    return FALSE;
+
+  for (guint i = 0; i < len - 1; i++) {
+    guint pos = step > 0 ? i : i + 1;
+
+    if (!equal (old_items[pos + step], new_items[pos]))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * ms_util_diff_lists:
+ * @old_items: The current items
+ * @old_len: The number of current items
+ * @new_items: The wanted items
+ * @new_len: The number of wanted items
+ * @equal: Function to compare items
+ *
+ * Find a small change turning @old_items into @new_items. Unchanged
+ * items at the start and end are skipped. If what's left is a single
+ * item moved up or down this is a move, otherwise the remaining items
+ * need to be replaced by the ones from @new_items at the same
+ * position.
+ *
+ * Returns: The change
+ */
+MsListDiff
+ms_util_diff_lists (gpointer   *old_items,
+                    guint       old_len,
+                    gpointer   *new_items,
+                    guint       new_len,
+                    GEqualFunc  equal)
+{
+  MsListDiff diff = { MS_LIST_DIFF_NONE, 0, 0, 0, 0 };
+  guint prefix = 0, suffix = 0, len;
+
+  while (prefix < MIN (old_len, new_len) && equal (old_items[prefix], new_items[prefix]))
+    prefix++;
+
+  while (suffix < MIN (old_len, new_len) - prefix &&
+         equal (old_items[old_len - 1 - suffix], new_items[new_len - 1 - suffix]))
+    suffix++;
+
+  diff.position = prefix;
+  diff.n_removed = old_len - prefix - suffix;
+  diff.n_added = new_len - prefix - suffix;
+  if (diff.n_removed == 0 && diff.n_added == 0)
+    return diff;
+
+  len = diff.n_removed;
+  if (len == diff.n_added && len > 1) {
+    if (is_rotated (&old_items[prefix], &new_items[prefix], len, 1, equal)) {
+      diff.type = MS_LIST_DIFF_MOVE;
+      diff.dest = prefix + len - 1;
+      return diff;
+    }
+
+    if (is_rotated (&old_items[prefix], &new_items[prefix], len, -1, equal)) {
+      diff.type = MS_LIST_DIFF_MOVE;
+      diff.position = prefix + len - 1;
+      diff.dest = prefix;
+      return diff;
+    }
+  }
+
+  diff.type = MS_LIST_DIFF_SPLICE;
+  return diff;
+}
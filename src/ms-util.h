@@ -21,6 +21,30 @@ typedef enum {
   MS_END_SESSION_MODE_REBOOT,
 } MsEndSessionMode;
 
+typedef enum {
+  MS_LIST_DIFF_NONE,
+  MS_LIST_DIFF_MOVE,
+  MS_LIST_DIFF_SPLICE,
+} MsListDiffType;
+
+/**
+ * MsListDiff:
+ * @type: The kind of change
+ * @position: The position of the moved item or where the splice starts
+ * @dest: Where the moved item gets inserted after removing it
+ * @n_removed: The number of items removed by the splice
+ * @n_added: The number of items added by the splice
+ *
+ * The change turning one list into another, see ms_util_diff_lists().
+ */
+typedef struct {
+  MsListDiffType type;
+  guint          position;
+  guint          dest;
+  guint          n_removed;
+  guint          n_added;
+} MsListDiff;
+
 #define GM_STR_IS_NULL_OR_EMPTY(x) ((x) == NULL || (x)[0] == '\0')
 
 char             *ms_munge_app_id (const char *app_id);
@@ -49,5 +73,11 @@ GtkStringList    *ms_get_casefolded_string_list (GtkStringList *strlist);
 const char       *ms_get_event_id_for_media_role (MsMediaRole role);
 const char       *ms_get_media_role_as_string (MsMediaRole role);
 void              ms_util_end_session (MsEndSessionMode mode);
+void              ms_util_trim_memory (void);
+MsListDiff        ms_util_diff_lists (gpointer   *old_items,
+                                      guint       old_len,
+                                      gpointer   *new_items,
+                                      guint       new_len,
+                                      GEqualFunc  equal);
 
 G_END_DECLS
@@ -14,6 +14,10 @@
 
 #include "ms-application.h"
 #include "ms-cc-panels.h"
+#include "ms-panel-factory.h"
+#include "ms-panel-prewarmer.h"
+#include "ms-trace.h"
+#include "ms-util.h"
 #include "ms-window.h"
 
 #include "ms-plugin-panel.h"
@@ -21,8 +25,14 @@
 #include "conf-tweaks/ms-tweaks-parser.h"
 #include "conf-tweaks/ms-tweaks-preferences-page.h"
 
+#include "libpms.h"
+
 #include <glib/gi18n.h>
 
+#define MAX_RECENT_PANELS 5
+/* Heavy panels not shown for that long get released */
+#define PANEL_IDLE_TIMEOUT_S (5 * 60)
+#define PANEL_IDLE_CHECK_INTERVAL_S 60
 
 struct _MsWindow {
   AdwApplicationWindow    parent_instance;
@@ -37,6 +47,19 @@ struct _MsWindow {
 
   GSettings *settings;
   MsTweaksParser         *ms_tweaks_parser;
+  MsPanelPrewarmer       *prewarmer;
+
+  /* Panel eviction */
+  GMemoryMonitor         *memory_monitor;
+  GHashTable             *panel_last_used;
+  char                   *visible_panel;
+  guint                   idle_check_id;
+  /* Never shown panels aren't released until prewarming is done */
+  gboolean                prewarming;
+
+  /* Loading the device plugin loads its module so it's done after startup */
+  guint                   device_probe_id;
+  gboolean                device_probed;
 };
 
 G_DEFINE_TYPE (MsWindow, ms_window, ADW_TYPE_APPLICATION_WINDOW)
@@ -69,6 +92,34 @@ on_search_activated (GtkWidget *widget, const char *action_name, GVariant *param
 }
 
 
+static void
+add_recent_panel (MsWindow *self, const char *name)
+{
+  g_auto (GStrv) recent = NULL;
+  g_auto (GStrv) updated = NULL;
+  g_autoptr (GStrvBuilder) builder = NULL;
+  guint n = 1;
+
+  if (name == NULL)
+    return;
+
+  recent = g_settings_get_strv (self->settings, "recent-panels");
+  builder = g_strv_builder_new ();
+  g_strv_builder_add (builder, name);
+  for (guint i = 0; recent[i] && n < MAX_RECENT_PANELS; i++) {
+    if (g_str_equal (recent[i], name))
+      continue;
+
+    g_strv_builder_add (builder, recent[i]);
+    n++;
+  }
+  updated = g_strv_builder_end (builder);
+
+  if (!g_strv_equal ((const char * const *) recent, (const char * const *) updated))
+    g_settings_set_strv (self->settings, "recent-panels", (const char * const *) updated);
+}
+
+
 static void
 show_content_cb (MsWindow *self)
 {
@@ -79,6 +130,7 @@ show_content_cb (MsWindow *self)
   panelname = adw_view_stack_get_visible_child_name (self->stack);
 
   g_settings_set_string (self->settings, "last-panel", panelname);
+  add_recent_panel (self, panelname);
 
   /* Clear search entry to display all panels again */
   if (gtk_search_bar_get_search_mode (self->search_bar)) {
@@ -106,6 +158,221 @@ stack_child_to_title (gpointer target, AdwViewStack *stack, GtkWidget *child)
 }
 
 
+static void
+ensure_visible_panel (MsWindow *self)
+{
+  GtkWidget *child = adw_view_stack_get_visible_child (self->stack);
+  const char *name = adw_view_stack_get_visible_child_name (self->stack);
+
+  if (!MS_IS_PANEL (child) || !ms_panel_factory_has_panel (name))
+    return;
+
+  ms_panel_factory_ensure (name, MS_PANEL (child));
+}
+
+
+static guint
+get_monotonic_seconds (void)
+{
+  return g_get_monotonic_time () / G_USEC_PER_SEC;
+}
+
+
+static void
+on_visible_child_changed (MsWindow *self)
+{
+  const char *name = adw_view_stack_get_visible_child_name (self->stack);
+
+  /* Remember when a panel was last shown so idle ones can be released */
+  if (self->visible_panel) {
+    g_hash_table_insert (self->panel_last_used,
+                         g_steal_pointer (&self->visible_panel),
+                         GUINT_TO_POINTER (get_monotonic_seconds ()));
+  }
+  self->visible_panel = g_strdup (name);
+
+  /* Until the window is mapped the visible child might still change */
+  if (!gtk_widget_get_mapped (GTK_WIDGET (self)))
+    return;
+
+  ensure_visible_panel (self);
+}
+
+
+static gboolean
+is_idle_releasable (MsWindow *self, const char *name, GtkWidget *child)
+{
+  if (!ms_panel_factory_is_heavy (name))
+    return FALSE;
+
+  if (self->prewarming && !g_hash_table_contains (self->panel_last_used, name))
+    return FALSE;
+
+  return adw_bin_get_child (ADW_BIN (child)) != NULL;
+}
+
+
+static gboolean
+has_idle_releasable_panels (MsWindow *self)
+{
+  GListModel *pages = G_LIST_MODEL (adw_view_stack_get_pages (self->stack));
+
+  for (guint i = 0; i < g_list_model_get_n_items (pages); i++) {
+    g_autoptr (AdwViewStackPage) page = g_list_model_get_item (pages, i);
+    const char *name = adw_view_stack_page_get_name (page);
+
+    if (!ms_panel_factory_has_panel (name))
+      continue;
+
+    if (is_idle_releasable (self, name, adw_view_stack_page_get_child (page)))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+/*
+ * Release built-in panels that were built but aren't shown. If
+ * @unused_for is non-zero only panels that weren't shown for at
+ * least @unused_for seconds are released. Panels that were prewarmed
+ * but never shown count from the end of prewarming.
+ */
+static guint
+release_panels (MsWindow *self, gboolean heavy_only, guint unused_for)
+{
+  GListModel *pages;
+  GtkWidget *visible_child;
+  guint now = get_monotonic_seconds ();
+  guint released = 0;
+
+  pages = G_LIST_MODEL (adw_view_stack_get_pages (self->stack));
+  visible_child = adw_view_stack_get_visible_child (self->stack);
+
+  for (guint i = 0; i < g_list_model_get_n_items (pages); i++) {
+    g_autoptr (AdwViewStackPage) page = g_list_model_get_item (pages, i);
+    const char *name = adw_view_stack_page_get_name (page);
+    GtkWidget *child = adw_view_stack_page_get_child (page);
+    gpointer last_used;
+
+    if (!ms_panel_factory_has_panel (name))
+      continue;
+
+    if (heavy_only && !ms_panel_factory_is_heavy (name))
+      continue;
+
+    if (child == visible_child && (heavy_only || gtk_widget_get_mapped (GTK_WIDGET (self))))
+      continue;
+
+    if (adw_bin_get_child (ADW_BIN (child)) == NULL)
+      continue;
+
+    if (unused_for) {
+      if (!is_idle_releasable (self, name, child))
+        continue;
+
+      /* Built but never shown, start counting now */
+      if (!g_hash_table_lookup_extended (self->panel_last_used, name, NULL, &last_used)) {
+        g_hash_table_insert (self->panel_last_used, g_strdup (name), GUINT_TO_POINTER (now));
+        continue;
+      }
+
+      if (now - GPOINTER_TO_UINT (last_used) < unused_for)
+        continue;
+    }
+
+    if (ms_panel_factory_release (name, MS_PANEL (child))) {
+      g_hash_table_remove (self->panel_last_used, name);
+      released++;
+    }
+  }
+
+  return released;
+}
+
+
+static gboolean
+on_idle_check_timeout (gpointer user_data)
+{
+  MsWindow *self = MS_WINDOW (user_data);
+  guint released;
+
+  released = release_panels (self, TRUE, PANEL_IDLE_TIMEOUT_S);
+  if (released) {
+    g_debug ("Released %u idle panels", released);
+    ms_util_trim_memory ();
+  }
+
+  /* Releasing the last panel disarmed us */
+  return self->idle_check_id ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+
+/* Only wake up periodically while there are panels to release */
+static void
+update_idle_check (MsWindow *self)
+{
+  gboolean needed;
+
+  needed = gtk_widget_get_mapped (GTK_WIDGET (self)) && has_idle_releasable_panels (self);
+
+  if (!needed) {
+    g_clear_handle_id (&self->idle_check_id, g_source_remove);
+    return;
+  }
+
+  if (self->idle_check_id)
+    return;
+
+  self->idle_check_id = g_timeout_add_seconds (PANEL_IDLE_CHECK_INTERVAL_S,
+                                               on_idle_check_timeout,
+                                               self);
+  g_source_set_name_by_id (self->idle_check_id, "[ms] release idle panels");
+}
+
+
+static void
+on_low_memory_warning (MsWindow                  *self,
+                       GMemoryMonitorWarningLevel level,
+                       GMemoryMonitor            *monitor)
+{
+  guint released;
+
+  if (!gtk_widget_get_mapped (GTK_WIDGET (self)))
+    return;
+
+  released = release_panels (self, TRUE, 0);
+  g_debug ("Low memory warning %d, released %u panels", level, released);
+  ms_util_trim_memory ();
+}
+
+
+static void
+setup_panels (MsWindow *self)
+{
+  GListModel *pages = G_LIST_MODEL (adw_view_stack_get_pages (self->stack));
+
+  for (guint i = 0; i < g_list_model_get_n_items (pages); i++) {
+    g_autoptr (AdwViewStackPage) page = g_list_model_get_item (pages, i);
+    const char *name = adw_view_stack_page_get_name (page);
+    GtkWidget *child = adw_view_stack_page_get_child (page);
+
+    if (!ms_panel_factory_has_panel (name))
+      continue;
+
+    ms_panel_factory_setup (name, MS_PANEL (child));
+
+    if (ms_panel_factory_is_heavy (name)) {
+      g_signal_connect_object (child,
+                               "notify::child",
+                               G_CALLBACK (update_idle_check),
+                               self,
+                               G_CONNECT_SWAPPED);
+    }
+  }
+}
+
+
 static void
 add_ms_tweaks_page (gpointer value, gpointer user_data)
 {
@@ -161,31 +428,31 @@ on_panel_enabled_changed (MsWindow *self, GParamSpec *pspec, MsPanel *panel)
 }
 
 
+static gboolean
+on_device_probe (gpointer user_data)
+{
+  MsWindow *self = MS_WINDOW (user_data);
+
+  self->device_probe_id = 0;
+  ms_window_ensure_device_panel (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 ms_settings_window_constructed (GObject *object)
 {
   MsWindow *self = MS_WINDOW (object);
   MsApplication *app = MS_APPLICATION (g_application_get_default ());
-  GtkWidget *device_panel;
   GHashTable *parser_page_table = NULL;
+  gint64 begin;
 
   G_OBJECT_CLASS (ms_window_parent_class)->constructed (object);
 
-  if (adw_view_stack_get_child_by_name (self->stack, "device") == NULL) {
-    const char *title;
-
-    g_assert (GTK_IS_APPLICATION (app));
-    device_panel = ms_application_get_device_panel (app);
-    if (device_panel) {
-      AdwViewStackPage *page;
-
-      title = ms_plugin_panel_get_title (MS_PLUGIN_PANEL (device_panel));
-      page = adw_view_stack_add_titled (self->stack, device_panel, "device", title ?: _("Device"));
-      adw_view_stack_page_set_icon_name (page, "phone-symbolic");
-    }
-  }
-
+  begin = ms_trace_begin ();
   ms_tweaks_parser_parse_definition_files (self->ms_tweaks_parser, TWEAKS_DATA_DIR);
+  ms_trace_end (begin, "tweaks-parse", NULL);
   parser_page_table = ms_tweaks_parser_get_page_table (self->ms_tweaks_parser);
 
   if (g_hash_table_size (parser_page_table) != 0) {
@@ -204,11 +471,114 @@ ms_settings_window_constructed (GObject *object)
 }
 
 
+static void
+start_prewarm (MsWindow *self)
+{
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_autofree char *last_panel = NULL;
+  g_auto (GStrv) recent = NULL;
+  g_auto (GStrv) names = NULL;
+
+  /* Most likely used panels first */
+  last_panel = g_settings_get_string (self->settings, "last-panel");
+  g_strv_builder_add (builder, last_panel);
+  recent = g_settings_get_strv (self->settings, "recent-panels");
+  g_strv_builder_addv (builder, (const char **) recent);
+  names = g_strv_builder_end (builder);
+
+  self->prewarming = TRUE;
+  ms_panel_prewarmer_start (self->prewarmer, (const char * const *) names);
+}
+
+
+static void
+on_prewarm_finished (MsWindow *self)
+{
+  GListModel *pages = G_LIST_MODEL (adw_view_stack_get_pages (self->stack));
+  guint now = get_monotonic_seconds ();
+
+  self->prewarming = FALSE;
+
+  /* Start the idle clock of panels that were built but never shown */
+  for (guint i = 0; i < g_list_model_get_n_items (pages); i++) {
+    g_autoptr (AdwViewStackPage) page = g_list_model_get_item (pages, i);
+    const char *name = adw_view_stack_page_get_name (page);
+    GtkWidget *child = adw_view_stack_page_get_child (page);
+
+    if (!ms_panel_factory_has_panel (name) || adw_bin_get_child (ADW_BIN (child)) == NULL)
+      continue;
+
+    if (!g_hash_table_contains (self->panel_last_used, name))
+      g_hash_table_insert (self->panel_last_used, g_strdup (name), GUINT_TO_POINTER (now));
+  }
+
+  update_idle_check (self);
+}
+
+
+static void
+on_first_frame (GdkFrameClock *frame_clock, MsWindow *self)
+{
+  g_signal_handlers_disconnect_by_func (frame_clock, on_first_frame, self);
+
+  if (ms_trace_is_enabled ())
+    ms_trace_startup_done ();
+
+  /* The language panel needs these, load them off the main thread */
+  ms_lang_prefetch_locale_names ();
+
+  if (!self->device_probed && self->device_probe_id == 0) {
+    self->device_probe_id = g_idle_add_full (G_PRIORITY_LOW, on_device_probe, self, NULL);
+    g_source_set_name_by_id (self->device_probe_id, "[ms] probe device panel");
+  }
+
+  start_prewarm (self);
+}
+
+
+static void
+ms_window_map (GtkWidget *widget)
+{
+  MsWindow *self = MS_WINDOW (widget);
+
+  GTK_WIDGET_CLASS (ms_window_parent_class)->map (widget);
+
+  ensure_visible_panel (self);
+  update_idle_check (self);
+
+  g_signal_connect_object (gtk_widget_get_frame_clock (widget),
+                           "after-paint",
+                           G_CALLBACK (on_first_frame),
+                           self,
+                           G_CONNECT_DEFAULT);
+}
+
+
+static void
+ms_window_unmap (GtkWidget *widget)
+{
+  MsWindow *self = MS_WINDOW (widget);
+
+  ms_panel_prewarmer_stop (self->prewarmer);
+  self->prewarming = FALSE;
+  g_clear_handle_id (&self->idle_check_id, g_source_remove);
+  ms_trace_window_hidden ();
+
+  GTK_WIDGET_CLASS (ms_window_parent_class)->unmap (widget);
+}
+
+
 static void
 ms_settings_window_dispose (GObject *object)
 {
   MsWindow *self = MS_WINDOW (object);
 
+  g_clear_handle_id (&self->idle_check_id, g_source_remove);
+  g_clear_handle_id (&self->device_probe_id, g_source_remove);
+  g_clear_object (&self->memory_monitor);
+  g_clear_pointer (&self->panel_last_used, g_hash_table_destroy);
+  g_clear_pointer (&self->visible_panel, g_free);
+  g_clear_object (&self->prewarmer);
   g_clear_object (&self->enabled_pages);
   g_clear_object (&self->settings);
   g_clear_object (&self->ms_tweaks_parser);
@@ -226,6 +596,9 @@ ms_window_class_init (MsWindowClass *klass)
   object_class->constructed = ms_settings_window_constructed;
   object_class->dispose = ms_settings_window_dispose;
 
+  widget_class->map = ms_window_map;
+  widget_class->unmap = ms_window_unmap;
+
   gtk_widget_class_set_template_from_resource (widget_class,
                                                "/mobi/phosh/MobileSettings/ui/ms-window.ui");
   gtk_widget_class_bind_template_child (widget_class, MsWindow, search_bar);
@@ -274,6 +647,26 @@ ms_window_init (MsWindow *self)
   self->enabled_pages = G_LIST_MODEL (gtk_filter_list_model_new (pages,
                                                                  GTK_FILTER (enabled_filter)));
 
+  setup_panels (self);
+  self->prewarmer = ms_panel_prewarmer_new (GTK_WIDGET (self), self->stack);
+  g_signal_connect_object (self->prewarmer,
+                           "finished",
+                           G_CALLBACK (on_prewarm_finished),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  self->panel_last_used = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->memory_monitor = g_memory_monitor_dup_default ();
+  g_signal_connect_object (self->memory_monitor,
+                           "low-memory-warning",
+                           G_CALLBACK (on_low_memory_warning),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_swapped (self->stack,
+                            "notify::visible-child",
+                            G_CALLBACK (on_visible_child_changed),
+                            self);
+
   show_content_cb (self);
   ms_cc_panels_add_all (self);
 
@@ -319,3 +712,71 @@ ms_window_insert_cc_panel (MsWindow *self, const char *name, GtkWidget *cc_panel
   adw_bin_set_child (ADW_BIN (child), cc_panel);
   ms_panel_set_enabled (MS_PANEL (child), TRUE);
 }
+
+/**
+ * ms_window_release_panels:
+ * @self: The window
+ * @heavy_only: Whether to only release panels that use a lot of memory
+ *
+ * Release the built-in panels that were built but aren't shown. They
+ * get built again when needed. The visible panel is only released
+ * when the window is hidden and @heavy_only is %FALSE.
+ *
+ * Returns: The number of released panels
+ */
+guint
+ms_window_release_panels (MsWindow *self, gboolean heavy_only)
+{
+  g_assert (MS_IS_WINDOW (self));
+
+  return release_panels (self, heavy_only, 0);
+}
+
+/**
+ * ms_window_ensure_device_panel:
+ * @self: The window
+ *
+ * Load the device plugin and add its panel unless that already
+ * happened. This happens automatically once the window is shown.
+ *
+ * Returns: %TRUE if there's a device panel
+ */
+gboolean
+ms_window_ensure_device_panel (MsWindow *self)
+{
+  MsApplication *app = MS_APPLICATION (g_application_get_default ());
+  g_autoptr (GtkStringList) keywords = NULL;
+  GtkWidget *placeholder, *device_panel;
+  const char *title;
+
+  g_assert (MS_IS_WINDOW (self));
+
+  placeholder = adw_view_stack_get_child_by_name (self->stack, "device");
+  if (adw_bin_get_child (ADW_BIN (placeholder)))
+    return TRUE;
+
+  if (self->device_probed)
+    return FALSE;
+
+  self->device_probed = TRUE;
+  g_clear_handle_id (&self->device_probe_id, g_source_remove);
+
+  g_assert (GTK_IS_APPLICATION (app));
+  device_panel = ms_application_get_device_panel (app);
+  if (device_panel == NULL)
+    return FALSE;
+
+  title = ms_plugin_panel_get_title (MS_PLUGIN_PANEL (device_panel));
+  if (title)
+    adw_view_stack_page_set_title (adw_view_stack_get_page (self->stack, placeholder), title);
+
+  g_object_get (device_panel, "keywords", &keywords, NULL);
+  if (keywords)
+    ms_panel_set_keywords (MS_PANEL (placeholder), keywords);
+
+  adw_bin_set_child (ADW_BIN (placeholder), device_panel);
+  g_object_bind_property (device_panel, "ready", placeholder, "ready", G_BINDING_SYNC_CREATE);
+  ms_panel_set_enabled (MS_PANEL (placeholder), TRUE);
+
+  return TRUE;
+}
@@ -19,10 +19,13 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (MsWindow, ms_window, MS, WINDOW, AdwApplicationWindow)
 
-GListModel *     ms_window_get_stack_pages    (MsWindow *self);
-MsPanelSwitcher *ms_window_get_panel_switcher (MsWindow *self);
-void             ms_window_insert_cc_panel    (MsWindow   *self,
-                                               const char *name,
-                                               GtkWidget  *cc_panel);
+GListModel *     ms_window_get_stack_pages     (MsWindow *self);
+MsPanelSwitcher *ms_window_get_panel_switcher  (MsWindow *self);
+void             ms_window_insert_cc_panel     (MsWindow   *self,
+                                                const char *name,
+                                                GtkWidget  *cc_panel);
+guint            ms_window_release_panels      (MsWindow   *self,
+                                                gboolean    heavy_only);
+gboolean         ms_window_ensure_device_panel (MsWindow *self);
 
 G_END_DECLS
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "test-util-diff-lists"
+
+#include "ms-util.h"
+
+
+struct {
+  const char     *old;
+  const char     *new;
+  MsListDiffType  type;
+  guint           position;
+  guint           dest;
+  guint           n_removed;
+  guint           n_added;
+} diff_cases[] = {
+  /* Nothing changed */
+  { "",      "",      MS_LIST_DIFF_NONE,   0, 0, 0, 0 },
+  { "abcd",  "abcd",  MS_LIST_DIFF_NONE,   0, 0, 0, 0 },
+
+  /* A single item moved up or down */
+  { "abcde", "acdbe", MS_LIST_DIFF_MOVE,   1, 3, 3, 3 },
+  { "abcde", "adbce", MS_LIST_DIFF_MOVE,   3, 1, 3, 3 },
+  { "abcd",  "bcda",  MS_LIST_DIFF_MOVE,   0, 3, 4, 4 },
+  { "abcd",  "dabc",  MS_LIST_DIFF_MOVE,   3, 0, 4, 4 },
+  { "abcd",  "bacd",  MS_LIST_DIFF_MOVE,   0, 1, 2, 2 },
+
+  /* Unchanged prefix and suffix are skipped */
+  { "abcd",  "axyd",  MS_LIST_DIFF_SPLICE, 1, 0, 2, 2 },
+  { "abcde", "adcbe", MS_LIST_DIFF_SPLICE, 1, 0, 3, 3 },
+  { "abcd",  "wxyz",  MS_LIST_DIFF_SPLICE, 0, 0, 4, 4 },
+
+  /* Insertions and removals */
+  { "",      "ab",    MS_LIST_DIFF_SPLICE, 0, 0, 0, 2 },
+  { "ab",    "",      MS_LIST_DIFF_SPLICE, 0, 0, 2, 0 },
+  { "abc",   "axbc",  MS_LIST_DIFF_SPLICE, 1, 0, 0, 1 },
+  { "abc",   "abcx",  MS_LIST_DIFF_SPLICE, 3, 0, 0, 1 },
+  { "abc",   "ac",    MS_LIST_DIFF_SPLICE, 1, 0, 1, 0 },
+  { "abc",   "bc",    MS_LIST_DIFF_SPLICE, 0, 0, 1, 0 },
+
+  /* Duplicates */
+  { "ab",    "aab",   MS_LIST_DIFF_SPLICE, 1, 0, 0, 1 },
+  { "aab",   "ab",    MS_LIST_DIFF_SPLICE, 1, 0, 1, 0 },
+  { "aab",   "aba",   MS_LIST_DIFF_MOVE,   1, 2, 2, 2 },
+  { "abab",  "baba",  MS_LIST_DIFF_MOVE,   0, 3, 4, 4 },
+};
+
+
+static GPtrArray *
+to_items (const char *str)
+{
+  GPtrArray *items = g_ptr_array_new_with_free_func (g_free);
+
+  for (const char *c = str; *c; c++)
+    g_ptr_array_add (items, g_strndup (c, 1));
+
+  return items;
+}
+
+
+static char *
+to_str (GPtrArray *items)
+{
+  GString *str = g_string_new (NULL);
+
+  for (guint i = 0; i < items->len; i++)
+    g_string_append (str, g_ptr_array_index (items, i));
+
+  return g_string_free (str, FALSE);
+}
+
+
+static void
+apply_diff (GPtrArray *items, GPtrArray *new_items, MsListDiff *diff)
+{
+  gpointer item;
+
+  switch (diff->type) {
+  case MS_LIST_DIFF_NONE:
+    break;
+  case MS_LIST_DIFF_MOVE:
+    item = g_ptr_array_steal_index (items, diff->position);
+    g_ptr_array_insert (items, diff->dest, item);
+    break;
+  case MS_LIST_DIFF_SPLICE:
+    g_ptr_array_remove_range (items, diff->position, diff->n_removed);
+    for (guint i = 0; i < diff->n_added; i++) {
+      item = g_strdup (g_ptr_array_index (new_items, diff->position + i));
+      g_ptr_array_insert (items, diff->position + i, item);
+    }
+    break;
+  default:
+    g_assert_not_reached ();
+  }
+}
+
+
+static void
+test_util_diff_lists (void)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (diff_cases); i++) {
+    g_autoptr (GPtrArray) old_items = to_items (diff_cases[i].old);
+    g_autoptr (GPtrArray) new_items = to_items (diff_cases[i].new);
+    g_autofree char *result = NULL;
+    MsListDiff diff;
+
+    g_test_message ("'%s' -> '%s'", diff_cases[i].old, diff_cases[i].new);
+
+    diff = ms_util_diff_lists (old_items->pdata, old_items->len,
+                               new_items->pdata, new_items->len,
+                               g_str_equal);
+
+    g_assert_cmpint (diff.type, ==, diff_cases[i].type);
+    if (diff.type != MS_LIST_DIFF_NONE) {
+      g_assert_cmpuint (diff.position, ==, diff_cases[i].position);
+      g_assert_cmpuint (diff.n_removed, ==, diff_cases[i].n_removed);
+      g_assert_cmpuint (diff.n_added, ==, diff_cases[i].n_added);
+    }
+    if (diff.type == MS_LIST_DIFF_MOVE)
+      g_assert_cmpuint (diff.dest, ==, diff_cases[i].dest);
+
+    apply_diff (old_items, new_items, &diff);
+    result = to_str (old_items);
+    g_assert_cmpstr (result, ==, diff_cases[i].new);
+  }
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh-mobile-settings/test-util-diff-lists", test_util_diff_lists);
+
+  return g_test_run ();
+}